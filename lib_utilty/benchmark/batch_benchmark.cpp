@@ -0,0 +1,154 @@
+/***********************************************
+*öʱ,Ҫ,JSON׼.
+*10^410^510^61СʱĶʱ,ֱSetATimerúSetTimersһ,StopATimerֹͣStopTimersһֹͣ:
+*call_ns:߳ÿʱĺʱ;
+*applied_ns:ӿʼõʱ̴߳(GetTimerCountﵽĿֵ)ÿʱĺʱ.
+*÷: batch_benchmark [--max-timers N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include "lib_utility.h"
+
+namespace {
+
+	class EmptyNotify : public utility::TimerNotify
+	{
+	public:
+		void OnTimerNotify() {}
+	};
+
+	struct PhaseResult
+	{
+		double call_ns;
+		double applied_ns;
+	};
+
+	struct BatchResult
+	{
+		size_t timers;
+		bool bulk;
+		PhaseResult arm;
+		PhaseResult cancel;
+		bool ok;
+	};
+
+	enum { INTERVAL_MS = 3600000 };
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	void WaitTimerCount(utility::TimerThread& timer_thread, unsigned count)
+	{
+		while (timer_thread.GetTimerCount() != count)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	BatchResult BenchBatch(size_t timers, bool bulk)
+	{
+		BatchResult result;
+		memset(&result, 0, sizeof(result));
+		result.timers = timers;
+		result.bulk = bulk;
+		utility::TimerThread timer_thread(1);
+		timer_thread.StartTimerThread();
+
+		//֪ͨ󽻸ʱͷ,ڼʱ֮ǰ
+		std::vector<utility::TimerSetting> settings(timers);
+		for (size_t i = 0; i < timers; i++)
+		{
+			settings[i].timer_notify = new EmptyNotify();
+			settings[i].interval_time = INTERVAL_MS;
+			settings[i].timer_type = utility::ONCE;
+		}
+		std::vector<utility::TimerHandle> handles(timers);
+
+		unsigned long long start = NowNs();
+		if (bulk)
+		{
+			timer_thread.SetTimers(&settings[0], (int)timers, &handles[0]);
+		}
+		else
+		{
+			for (size_t i = 0; i < timers; i++)
+			{
+				handles[i] = timer_thread.SetATimer(settings[i].timer_notify, INTERVAL_MS, utility::ONCE);
+			}
+		}
+		unsigned long long called = NowNs();
+		WaitTimerCount(timer_thread, (unsigned)timers);
+		unsigned long long applied = NowNs();
+		result.arm.call_ns = (double)(called - start) / timers;
+		result.arm.applied_ns = (double)(applied - start) / timers;
+
+		start = NowNs();
+		if (bulk)
+		{
+			timer_thread.StopTimers(&handles[0], (int)timers);
+		}
+		else
+		{
+			for (size_t i = 0; i < timers; i++)
+			{
+				timer_thread.StopATimer(handles[i]);
+			}
+		}
+		called = NowNs();
+		WaitTimerCount(timer_thread, 0);
+		applied = NowNs();
+		result.cancel.call_ns = (double)(called - start) / timers;
+		result.cancel.applied_ns = (double)(applied - start) / timers;
+
+		result.ok = true;
+		for (size_t i = 0; i < timers; i++)
+		{
+			result.ok = result.ok && handles[i] != 0;
+		}
+		timer_thread.StopTimerThread();
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t max_timers = 1000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--max-timers") == 0 && i + 1 < argc)
+		{
+			max_timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--max-timers N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("{\n");
+	printf("  \"benchmark\": \"batch_arm\",\n");
+	printf("  \"interval_ms\": %d,\n", (int)INTERVAL_MS);
+	printf("  \"results\": [\n");
+	for (size_t timers = 10000; timers <= max_timers; timers *= 10)
+	{
+		for (int bulk = 0; bulk < 2; bulk++)
+		{
+			BatchResult result = BenchBatch(timers, bulk == 1);
+			bool last = timers * 10 > max_timers && bulk == 1;
+			printf("    {\"timers\": %zu, \"mode\": \"%s\", \"arm_call_ns\": %.1f, \"arm_applied_ns\": %.1f, "
+				"\"cancel_call_ns\": %.1f, \"cancel_applied_ns\": %.1f, \"ok\": %s}%s\n",
+				result.timers, result.bulk ? "bulk" : "one_by_one", result.arm.call_ns, result.arm.applied_ns,
+				result.cancel.call_ns, result.cancel.applied_ns, result.ok ? "true" : "false", last ? "" : ",");
+			fflush(stdout);
+		}
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+/***********************************************
+*ʱصʽĴ,Ҫ,JSON׼.
+*ֻص24ֽڵ(std::functionڲ):
+*virtual:TimerNotify,ͨ麯;
+*std_function:std::function<void()>,ӶϷ;
+*inline:ֱӷInlineFunction<48>ڲ,ָͨ.
+*dispatch:--timersصε,ÿεõĺʱ;
+*fire:TimerManagerе--timersζʱһDetectTimersȫ,ÿδĺʱ(std::functionTimerCallback).
+*÷: callback_benchmark [--timers N] [--rounds N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include "lib_utility.h"
+
+namespace {
+
+	struct Payload
+	{
+		unsigned long long* sink;
+		unsigned long long add;
+		unsigned long long pad;
+	};
+
+	class CountNotify : public utility::TimerNotify
+	{
+	public:
+		explicit CountNotify(const Payload& payload) : payload_(payload) {}
+		void OnTimerNotify() { *payload_.sink += payload_.add; }
+
+	private:
+		Payload payload_;
+	};
+
+	struct CallbackResult
+	{
+		double dispatch_ns;
+		double fire_ns;
+	};
+
+	enum CallbackKind { CALLBACK_VIRTUAL, CALLBACK_STD_FUNCTION, CALLBACK_INLINE };
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	double BenchDispatch(CallbackKind kind, size_t timers, int rounds, unsigned long long* sink)
+	{
+		Payload payload = { sink, 1, 0 };
+		std::vector<utility::TimerNotify*> notifies;
+		std::vector<std::function<void()> > functions;
+		std::vector<utility::TimerCallback> callbacks;
+		for (size_t i = 0; i < timers; i++)
+		{
+			if (kind == CALLBACK_VIRTUAL)
+			{
+				notifies.push_back(new CountNotify(payload));
+			}
+			else if (kind == CALLBACK_STD_FUNCTION)
+			{
+				functions.push_back([payload]() { *payload.sink += payload.add; });
+			}
+			else
+			{
+				callbacks.push_back(utility::TimerCallback([payload]() { *payload.sink += payload.add; }));
+			}
+		}
+
+		unsigned long long start = NowNs();
+		for (int r = 0; r < rounds; r++)
+		{
+			for (size_t i = 0; i < timers; i++)
+			{
+				if (kind == CALLBACK_VIRTUAL)
+				{
+					notifies[i]->OnTimerNotify();
+				}
+				else if (kind == CALLBACK_STD_FUNCTION)
+				{
+					functions[i]();
+				}
+				else
+				{
+					callbacks[i]();
+				}
+			}
+		}
+		unsigned long long elapsed = NowNs() - start;
+		for (size_t i = 0; i < notifies.size(); i++)
+		{
+			delete notifies[i];
+		}
+		return (double)elapsed / ((double)timers * rounds);
+	}
+
+	utility::TimerTask* NewTask(CallbackKind kind, const Payload& payload)
+	{
+		utility::TimerTask* timer_task = new utility::TimerTask();
+		if (kind == CALLBACK_VIRTUAL)
+		{
+			timer_task->SetTimerTask(new CountNotify(payload), 1, utility::ONCE);
+			return timer_task;
+		}
+		if (kind == CALLBACK_STD_FUNCTION)
+		{
+			std::function<void()> function = [payload]() { *payload.sink += payload.add; };
+			timer_task->SetTimerCallback(utility::TimerCallback(std::move(function)));
+		}
+		else
+		{
+			timer_task->SetTimerCallback(utility::TimerCallback([payload]() { *payload.sink += payload.add; }));
+		}
+		timer_task->SetTimerTask(NULL, 1, utility::ONCE);
+		return timer_task;
+	}
+
+	//ÿַеζʱ,ǵںʱһDetectTimers
+	double BenchFire(CallbackKind kind, size_t timers, int rounds, unsigned long long* sink)
+	{
+		Payload payload = { sink, 1, 0 };
+		utility::TimerManager manager(1);
+		std::vector<utility::TimerTask*> tasks(timers);
+		for (size_t i = 0; i < timers; i++)
+		{
+			tasks[i] = NewTask(kind, payload);
+		}
+		unsigned long long elapsed = 0;
+		for (int r = 0; r < rounds; r++)
+		{
+			for (size_t i = 0; i < timers; i++)
+			{
+				manager.AddTimer(tasks[i]);
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(3));
+			unsigned long long start = NowNs();
+			manager.DetectTimers();
+			elapsed += NowNs() - start;
+		}
+		for (size_t i = 0; i < timers; i++)
+		{
+			delete tasks[i];
+		}
+		return (double)elapsed / ((double)timers * rounds);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t timers = 100000;
+	int rounds = 20;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc)
+		{
+			timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+		{
+			rounds = atoi(argv[++i]);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--timers N] [--rounds N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (timers == 0)
+	{
+		timers = 1;
+	}
+	if (rounds <= 0)
+	{
+		rounds = 1;
+	}
+
+	const char* names[] = { "virtual", "std_function", "inline" };
+	const CallbackKind kinds[] = { CALLBACK_VIRTUAL, CALLBACK_STD_FUNCTION, CALLBACK_INLINE };
+	unsigned long long sink = 0;
+	printf("{\n");
+	printf("  \"benchmark\": \"callback_fire_cost\",\n");
+	printf("  \"timers\": %zu,\n", timers);
+	printf("  \"rounds\": %d,\n", rounds);
+	printf("  \"results\": [\n");
+	//ֻص3,ȡСֵ,ٶڴ˳Ӱ
+	CallbackResult results[3];
+	for (int pass = 0; pass < 3; pass++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			double dispatch_ns = BenchDispatch(kinds[i], timers, rounds, &sink);
+			double fire_ns = BenchFire(kinds[i], timers, rounds, &sink);
+			if (pass == 0 || dispatch_ns < results[i].dispatch_ns)
+			{
+				results[i].dispatch_ns = dispatch_ns;
+			}
+			if (pass == 0 || fire_ns < results[i].fire_ns)
+			{
+				results[i].fire_ns = fire_ns;
+			}
+		}
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		const CallbackResult& result = results[i];
+		printf("    {\"callback\": \"%s\", \"dispatch_ns\": %.2f, \"fire_ns\": %.1f}%s\n",
+			names[i], result.dispatch_ns, result.fire_ns, i < 2 ? "," : "");
+		fflush(stdout);
+	}
+	printf("  ],\n");
+	printf("  \"calls\": %llu\n", sink);
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+/***********************************************
+*ȡʱӳٲ,Ҫ,JSON׼.
+*ʱ߳10^3--max-live(Ĭ10^6)1СʱĶʱ,ȡ--cancels:
+*thread:TimerThread::StopATimer,ӵÿʼʱ̴߳(GetTimerCount),ÿȡĺʱ;
+*manager:TimerManager::RemoveTimer,ʱ߳дʱɾһʱĺʱ;
+*std_list:Ϊ±֮ǰ,std::list<TimerTask*>::removeɨĺʱ(ֻԱ).
+*÷: cancel_benchmark [--max-live N] [--cancels N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <list>
+#include <thread>
+#include <algorithm>
+#include "lib_utility.h"
+
+namespace {
+
+	enum { INTERVAL_MS = 3600000 };
+
+	struct CancelResult
+	{
+		size_t live;
+		size_t cancels;
+		double thread_ns;
+		double manager_ns;
+		double std_list_ns;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	//Ҫȡ±,ظ
+	std::vector<size_t> PickVictims(size_t live, size_t cancels)
+	{
+		std::vector<size_t> indexes(live);
+		for (size_t i = 0; i < live; i++)
+		{
+			indexes[i] = i;
+		}
+		unsigned seed = 12345;
+		for (size_t i = 0; i < cancels; i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			std::swap(indexes[i], indexes[i + (seed >> 8) % (live - i)]);
+		}
+		indexes.resize(cancels);
+		return indexes;
+	}
+
+	double BenchThread(size_t live, const std::vector<size_t>& victims)
+	{
+		utility::TimerThread timer_thread(1);
+		timer_thread.StartTimerThread();
+		std::vector<utility::TimerHandle> handles(live);
+		for (size_t i = 0; i < live; i++)
+		{
+			handles[i] = timer_thread.SetATimer([]() {}, INTERVAL_MS, utility::ONCE);
+		}
+		while (timer_thread.GetTimerCount() != live)
+		{
+			std::this_thread::yield();
+		}
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < victims.size(); i++)
+		{
+			timer_thread.StopATimer(handles[victims[i]]);
+		}
+		while (timer_thread.GetTimerCount() != live - victims.size())
+		{
+			std::this_thread::yield();
+		}
+		unsigned long long elapsed = NowNs() - start;
+		timer_thread.StopTimerThread();
+		return (double)elapsed / victims.size();
+	}
+
+	//ʱ߳еǲ:ʱɾ
+	double BenchManager(size_t live, const std::vector<size_t>& victims)
+	{
+		utility::TimerManager manager(1);
+		std::vector<utility::TimerTask*> tasks(live);
+		for (size_t i = 0; i < live; i++)
+		{
+			tasks[i] = new utility::TimerTask();
+			tasks[i]->SetTimerCallback(utility::TimerCallback([]() {}));
+			tasks[i]->SetTimerTask(NULL, INTERVAL_MS, utility::ONCE);
+			manager.AddTimer(tasks[i]);
+		}
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < victims.size(); i++)
+		{
+			manager.RemoveTimer(tasks[victims[i]]);
+		}
+		unsigned long long elapsed = NowNs() - start;
+		for (size_t i = 0; i < live; i++)
+		{
+			manager.RemoveTimer(tasks[i]);
+			delete tasks[i];
+		}
+		return (double)elapsed / victims.size();
+	}
+
+	double BenchStdList(size_t live, const std::vector<size_t>& victims)
+	{
+		std::vector<utility::TimerTask*> tasks(live);
+		std::list<utility::TimerTask*> task_list;
+		for (size_t i = 0; i < live; i++)
+		{
+			tasks[i] = new utility::TimerTask();
+			task_list.push_back(tasks[i]);
+		}
+		//ÿζɨ,live,ʹɨԪԼΪ10^8
+		size_t removes = std::max<size_t>(10, std::min<size_t>(victims.size(), 100000000 / live));
+		removes = std::min(removes, victims.size());
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < removes; i++)
+		{
+			task_list.remove(tasks[victims[i]]);
+		}
+		unsigned long long elapsed = NowNs() - start;
+		for (size_t i = 0; i < live; i++)
+		{
+			delete tasks[i];
+		}
+		return (double)elapsed / removes;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t max_live = 1000000;
+	size_t cancels = 10000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--max-live") == 0 && i + 1 < argc)
+		{
+			max_live = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--cancels") == 0 && i + 1 < argc)
+		{
+			cancels = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--max-live N] [--cancels N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (cancels == 0)
+	{
+		cancels = 1;
+	}
+
+	printf("{\n");
+	printf("  \"benchmark\": \"cancel_latency\",\n");
+	printf("  \"interval_ms\": %d,\n", (int)INTERVAL_MS);
+	printf("  \"results\": [\n");
+	for (size_t live = 1000; live <= max_live; live *= 10)
+	{
+		CancelResult result;
+		result.live = live;
+		result.cancels = std::min(cancels, live);
+		std::vector<size_t> victims = PickVictims(live, result.cancels);
+		result.thread_ns = BenchThread(live, victims);
+		result.manager_ns = BenchManager(live, victims);
+		result.std_list_ns = BenchStdList(live, victims);
+		bool last = live * 10 > max_live;
+		printf("    {\"live\": %zu, \"cancels\": %zu, \"thread_ns\": %.1f, \"manager_ns\": %.1f, \"std_list_ns\": %.0f}%s\n",
+			result.live, result.cancels, result.thread_ns, result.manager_ns, result.std_list_ns, last ? "" : ",");
+		fflush(stdout);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
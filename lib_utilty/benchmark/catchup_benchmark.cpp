@@ -0,0 +1,223 @@
+/***********************************************
+*ʱͣٲ,Ҫ,JSON׼.
+*ģⶨʱ߳ͣ(GC)--backlog-ms(Ĭ60s)֮һδлѹĿ̶:
+*bitmap:TimerWheel<1ms, 8, 6, 4>::AdvanceTo,òλͼյĿ̶;
+*slot_scan:ͬļβ,ԭķʽ̶ȼһĲ۲,Ϊ.
+*ʱĵڿ̶(0, 2*backlog]֮ȷֲ,Լһڲʱ,ֱΪ010010^410^5.
+*÷: catchup_benchmark [--backlog-ms N] [--repeat N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "lib_utility.h"
+
+namespace {
+
+	typedef utility::TimerWheel<1000000ULL, 8, 6, 4> Wheel;
+
+	//ԭ̶ɨʱ:һ256,464
+	class SlotScanWheel
+	{
+	public:
+		enum { ROOT_BITS = 8, LEVEL_BITS = 6, ROOT_SIZE = 1 << ROOT_BITS, LEVEL_SIZE = 1 << LEVEL_BITS };
+
+		explicit SlotScanWheel(unsigned long long start_tick) : check_tick_(start_tick) {}
+
+		void Insert(utility::TimerWheelHook* node)
+		{
+			unsigned long long expires = node->expire_tick_;
+			unsigned long long idx = expires - check_tick_;
+			int slot = 0;
+			if ((long long)idx < 0)
+			{
+				slot = (int)(check_tick_ & (ROOT_SIZE - 1));
+			}
+			else if (idx < ROOT_SIZE)
+			{
+				slot = (int)(expires & (ROOT_SIZE - 1));
+			}
+			else
+			{
+				int level = 0;
+				while (level < 3 && idx >= 1ULL << (ROOT_BITS + (level + 1) * LEVEL_BITS))
+				{
+					level++;
+				}
+				slot = Offset(level) + Index(expires, level);
+			}
+			node->slot_ = slot;
+			slots_[slot].PushBack(node);
+		}
+
+		template <class Handler>
+		void AdvanceTo(unsigned long long now_tick, Handler& handler)
+		{
+			while (check_tick_ <= now_tick)
+			{
+				int index = (int)(check_tick_ & (ROOT_SIZE - 1));
+				if (!index &&
+					!Cascade(0) &&
+					!Cascade(1) &&
+					!Cascade(2))
+				{
+					Cascade(3);
+				}
+				++check_tick_;
+
+				utility::TimerWheelList temp;
+				temp.SpliceFrom(slots_[index]);
+				while (!temp.IsEmpty())
+				{
+					handler.OnExpire(temp.PopFront());
+				}
+			}
+		}
+
+	private:
+		static int Offset(int level) { return ROOT_SIZE + level * LEVEL_SIZE; }
+		static int Index(unsigned long long tick, int level) { return (int)((tick >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1)); }
+
+		int Cascade(int level)
+		{
+			int index = Index(check_tick_, level);
+			utility::TimerWheelList temp;
+			temp.SpliceFrom(slots_[Offset(level) + index]);
+			while (!temp.IsEmpty())
+			{
+				Insert(temp.PopFront());
+			}
+			return index;
+		}
+
+		utility::TimerWheelList slots_[ROOT_SIZE + 4 * LEVEL_SIZE];
+		unsigned long long check_tick_;
+	};
+
+	struct CountingHandler
+	{
+		size_t fires;
+		void OnCascade(utility::TimerWheelHook*) {}
+		void OnExpire(utility::TimerWheelHook*) { fires++; }
+	};
+
+	struct CatchupResult
+	{
+		size_t timers;
+		size_t fires;
+		double bitmap_us;
+		double slot_scan_us;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	void MakeNodes(std::vector<utility::TimerWheelHook>& nodes, unsigned long long backlog)
+	{
+		unsigned seed = 12345;
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			nodes[i] = utility::TimerWheelHook();
+			nodes[i].expire_tick_ = 1 + (((unsigned long long)seed << 16) ^ i) % (2 * backlog);
+		}
+	}
+
+	CatchupResult BenchCatchup(size_t timers, unsigned long long backlog, int repeat)
+	{
+		CatchupResult result = { timers, 0, 0, 0 };
+		std::vector<utility::TimerWheelHook> nodes(timers);
+		for (int r = 0; r < repeat; r++)
+		{
+			//ÿ½ʱ,ֻƲʱ,ȡСֵ
+			MakeNodes(nodes, backlog);
+			Wheel* wheel = new Wheel(0);
+			for (size_t i = 0; i < timers; i++)
+			{
+				wheel->Insert(&nodes[i]);
+			}
+			CountingHandler handler = { 0 };
+			unsigned long long start = NowNs();
+			wheel->AdvanceTo(backlog, handler);
+			double elapsed = (double)(NowNs() - start) / 1000.0;
+			if (r == 0 || elapsed < result.bitmap_us)
+			{
+				result.bitmap_us = elapsed;
+			}
+			result.fires = handler.fires;
+			delete wheel;
+
+			MakeNodes(nodes, backlog);
+			SlotScanWheel* scan_wheel = new SlotScanWheel(0);
+			for (size_t i = 0; i < timers; i++)
+			{
+				scan_wheel->Insert(&nodes[i]);
+			}
+			CountingHandler scan_handler = { 0 };
+			start = NowNs();
+			scan_wheel->AdvanceTo(backlog, scan_handler);
+			elapsed = (double)(NowNs() - start) / 1000.0;
+			if (r == 0 || elapsed < result.slot_scan_us)
+			{
+				result.slot_scan_us = elapsed;
+			}
+			if (scan_handler.fires != handler.fires)
+			{
+				fprintf(stderr, "fire count mismatch: bitmap %zu, slot scan %zu\n", handler.fires, scan_handler.fires);
+			}
+			delete scan_wheel;
+		}
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long long backlog_ms = 60000;
+	int repeat = 5;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--backlog-ms") == 0 && i + 1 < argc)
+		{
+			backlog_ms = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = atoi(argv[++i]);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--backlog-ms N] [--repeat N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (backlog_ms == 0)
+	{
+		backlog_ms = 1;
+	}
+	if (repeat <= 0)
+	{
+		repeat = 1;
+	}
+
+	const size_t timer_counts[] = { 0, 100, 10000, 100000 };
+	const int count = sizeof(timer_counts) / sizeof(timer_counts[0]);
+	printf("{\n");
+	printf("  \"benchmark\": \"wheel_catchup\",\n");
+	printf("  \"tick_ms\": 1,\n");
+	printf("  \"backlog_ms\": %llu,\n", backlog_ms);
+	printf("  \"results\": [\n");
+	for (int i = 0; i < count; i++)
+	{
+		CatchupResult result = BenchCatchup(timer_counts[i], backlog_ms, repeat);
+		printf("    {\"timers\": %zu, \"fires\": %zu, \"bitmap_us\": %.3f, \"slot_scan_us\": %.3f, \"speedup\": %.1f}%s\n",
+			result.timers, result.fires, result.bitmap_us, result.slot_scan_us,
+			result.bitmap_us > 0 ? result.slot_scan_us / result.bitmap_us : 0, i + 1 < count ? "," : "");
+		fflush(stdout);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
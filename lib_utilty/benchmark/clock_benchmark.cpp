@@ -0,0 +1,109 @@
+/***********************************************
+*ʱӶȡ,Ҫ,JSON׼.
+*ÿʱȡ--calls,ÿεõĺʱ,ԼζȡСֵ(ʱӵʵʾ):
+*NowNs/CoarseNowNs/TscNowNs/CachedNowNs/NowMs:MonotonicClock;
+*steady_clock:std::chrono::steady_clock::nowԱ.
+*CachedNowNsֻڶʱ̱߳ʱ,ȵһUpdateCachedNow,һֱͬһֵ.
+*÷: clock_benchmark [--calls N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "lib_utility.h"
+
+namespace {
+
+	struct ClockResult
+	{
+		double ns_per_call;
+		unsigned long long resolution_ns;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	unsigned long long SteadyNowNs()
+	{
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	unsigned long long CachedNowNs()
+	{
+		return utility::MonotonicClock::CachedNowNs();
+	}
+
+	unsigned long long NowMsAsNs()
+	{
+		return utility::MonotonicClock::NowMs() * 1000000ULL;
+	}
+
+	//resolution_ns:ζȡСֵ,ֵһֱʱΪ0
+	template <class Clock>
+	ClockResult BenchClock(Clock clock, size_t calls)
+	{
+		ClockResult result = { 0, 0 };
+		unsigned long long previous = clock();
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < calls; i++)
+		{
+			unsigned long long now = clock();
+			if (now != previous && (result.resolution_ns == 0 || now - previous < result.resolution_ns))
+			{
+				result.resolution_ns = now - previous;
+			}
+			previous = now;
+		}
+		result.ns_per_call = (double)(NowNs() - start) / calls;
+		return result;
+	}
+
+	void PrintResult(const char* clock, const ClockResult& result, bool last)
+	{
+		printf("    {\"clock\": \"%s\", \"ns_per_call\": %.2f, \"resolution_ns\": %llu}%s\n",
+			clock, result.ns_per_call, result.resolution_ns, last ? "" : ",");
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t calls = 10000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--calls") == 0 && i + 1 < argc)
+		{
+			calls = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--calls N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (calls == 0)
+	{
+		calls = 1;
+	}
+
+	utility::MonotonicClock::UpdateCachedNow();
+	bool tsc = utility::MonotonicClock::IsTscAvailable();
+	printf("{\n");
+	printf("  \"benchmark\": \"clock_read\",\n");
+	printf("  \"calls\": %zu,\n", calls);
+	printf("  \"tsc_available\": %s,\n", tsc ? "true" : "false");
+	printf("  \"results\": [\n");
+	PrintResult("NowNs", BenchClock(utility::MonotonicClock::NowNs, calls), false);
+	PrintResult("CoarseNowNs", BenchClock(utility::MonotonicClock::CoarseNowNs, calls), false);
+	//֧TSCʱTscNowNs˻صNowNs
+	PrintResult(tsc ? "TscNowNs" : "TscNowNs(NowNs)", BenchClock(utility::MonotonicClock::TscNowNs, calls), false);
+	PrintResult("CachedNowNs", BenchClock(CachedNowNs, calls), false);
+	PrintResult("NowMs", BenchClock(NowMsAsNs, calls), false);
+	PrintResult("steady_clock", BenchClock(SteadyNowNs, calls), true);
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+/***********************************************
+*ʱѹ,Ҫ,JSON׼,ͨʱ1.
+*1.TimerCommandQueue:16߳ͬʱPush,һ߳Pop,һ,ÿߵͶ˳ȡ.
+*2.TimerThread:16߳ͬʱá(һ)ֹͣʱ,Ĭÿ߳25,400.
+*  ̼Ķʱֹ֮ͣǰ;10sĶʱڵ֮ǰֹͣ,ܴ.
+*  ֹ֮ͣʧЧľֹͣ,κ.ʱ߳еĶʱص0.
+*÷: command_queue_stress [--threads N] [--commands-per-thread N] [--timers-per-thread N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "lib_utility.h"
+
+namespace {
+
+	struct QueueResult
+	{
+		int producers;
+		size_t commands;
+		size_t received;
+		size_t out_of_order;
+		double elapsed_ms;
+	};
+
+	struct TimerResult
+	{
+		int threads;
+		size_t timers;
+		size_t short_fires;
+		size_t long_fires;
+		unsigned remaining_timers;
+		double elapsed_ms;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	QueueResult StressQueue(int producers, size_t per_producer)
+	{
+		QueueResult result = { producers, (size_t)producers * per_producer, 0, 0, 0 };
+		utility::TimerCommandQueue queue;
+		std::vector<unsigned long long> next_seq(producers, 0);
+
+		unsigned long long start = NowNs();
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; p++)
+		{
+			threads.push_back(std::thread([&queue, p, per_producer]() {
+				for (size_t i = 0; i < per_producer; i++)
+				{
+					utility::TimerCommand* command = new utility::TimerCommand();
+					command->cmd_type_ = utility::TIMER_CMD_CANCEL;
+					command->timer_task_ = NULL;
+					command->timer_handle_ = ((unsigned long long)p << 32) | i;
+					command->batch_tasks_ = NULL;
+					command->batch_handles_ = NULL;
+					queue.Push(command);
+				}
+			}));
+		}
+
+		//:PopΪʱNULL,ȡֱ
+		while (result.received < result.commands)
+		{
+			utility::TimerCommand* command = queue.Pop();
+			if (command == NULL)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			int p = (int)(command->timer_handle_ >> 32);
+			unsigned long long seq = command->timer_handle_ & 0xFFFFFFFFULL;
+			if (p < 0 || p >= producers || seq != next_seq[p])
+			{
+				result.out_of_order++;
+			}
+			if (p >= 0 && p < producers)
+			{
+				next_seq[p] = seq + 1;
+			}
+			result.received++;
+			delete command;
+		}
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i].join();
+		}
+		result.elapsed_ms = (double)(NowNs() - start) / 1e6;
+		return result;
+	}
+
+	TimerResult StressTimerThread(int thread_count, size_t per_thread)
+	{
+		const size_t ROUND = 256;
+		TimerResult result = { thread_count, (size_t)thread_count * per_thread, 0, 0, 0, 0 };
+		std::atomic<size_t> short_fires(0);
+		std::atomic<size_t> long_fires(0);
+		utility::TimerThread timer_thread(1);
+		timer_thread.StartTimerThread();
+
+		unsigned long long start = NowNs();
+		std::vector<std::thread> threads;
+		for (int t = 0; t < thread_count; t++)
+		{
+			threads.push_back(std::thread([&timer_thread, &short_fires, &long_fires, t, per_thread]() {
+				std::vector<utility::TimerHandle> handles(ROUND);
+				unsigned seed = (unsigned)t * 2654435761u + 1;
+				for (size_t done = 0; done < per_thread; done += ROUND)
+				{
+					size_t count = per_thread - done < ROUND ? per_thread - done : ROUND;
+					for (size_t i = 0; i < count; i++)
+					{
+						seed = seed * 1103515245u + 12345u;
+						if (i % 2 == 0)
+						{
+							handles[i] = timer_thread.SetATimer([&long_fires]() { long_fires.fetch_add(1, std::memory_order_relaxed); },
+								10000, utility::ONCE);
+						}
+						else
+						{
+							handles[i] = timer_thread.SetATimer([&short_fires]() { short_fires.fetch_add(1, std::memory_order_relaxed); },
+								1 + (seed >> 16) % 5, (seed & 1) ? utility::CIRCLE : utility::ONCE);
+						}
+					}
+					for (size_t i = 0; i < count; i += 3)
+					{
+						timer_thread.RescheduleTimer(handles[i], i % 2 == 0 ? 20000 : 2, (i & 4) != 0);
+					}
+					for (size_t i = 0; i < count; i++)
+					{
+						timer_thread.StopATimer(handles[i]);
+					}
+					//ʧЧľӰ֮䵽ͬһĶʱ
+					for (size_t i = 0; i < count; i += 7)
+					{
+						timer_thread.StopATimer(handles[i]);
+						timer_thread.RescheduleTimer(handles[i], 1, (i & 1) != 0);
+					}
+				}
+			}));
+		}
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i].join();
+		}
+
+		//֮ʱص0
+		unsigned long long deadline = NowNs() + 10000000000ULL;
+		while (timer_thread.GetTimerCount() != 0 && NowNs() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		result.elapsed_ms = (double)(NowNs() - start) / 1e6;
+		result.remaining_timers = timer_thread.GetTimerCount();
+		timer_thread.StopTimerThread();
+		result.short_fires = short_fires.load();
+		result.long_fires = long_fires.load();
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int threads = 16;
+	size_t commands_per_thread = 1000000;
+	size_t timers_per_thread = 250000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--commands-per-thread") == 0 && i + 1 < argc)
+		{
+			commands_per_thread = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--timers-per-thread") == 0 && i + 1 < argc)
+		{
+			timers_per_thread = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--threads N] [--commands-per-thread N] [--timers-per-thread N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (threads <= 0)
+	{
+		threads = 1;
+	}
+
+	QueueResult queue = StressQueue(threads, commands_per_thread);
+	TimerResult timers = StressTimerThread(threads, timers_per_thread);
+	bool queue_passed = queue.received == queue.commands && queue.out_of_order == 0;
+	bool timers_passed = timers.long_fires == 0 && timers.remaining_timers == 0;
+
+	printf("{\n");
+	printf("  \"benchmark\": \"command_queue_stress\",\n");
+	printf("  \"command_queue\": {\"producers\": %d, \"commands\": %zu, \"received\": %zu, \"out_of_order\": %zu, "
+		"\"elapsed_ms\": %.1f, \"commands_per_second\": %.0f, \"passed\": %s},\n",
+		queue.producers, queue.commands, queue.received, queue.out_of_order, queue.elapsed_ms,
+		queue.elapsed_ms > 0 ? queue.received / queue.elapsed_ms * 1000 : 0, queue_passed ? "true" : "false");
+	printf("  \"timer_thread\": {\"threads\": %d, \"timers\": %zu, \"short_fires\": %zu, \"long_fires\": %zu, "
+		"\"remaining_timers\": %u, \"elapsed_ms\": %.1f, \"timers_per_second\": %.0f, \"passed\": %s},\n",
+		timers.threads, timers.timers, timers.short_fires, timers.long_fires, timers.remaining_timers, timers.elapsed_ms,
+		timers.elapsed_ms > 0 ? timers.timers / timers.elapsed_ms * 1000 : 0, timers_passed ? "true" : "false");
+	printf("  \"passed\": %s\n", queue_passed && timers_passed ? "true" : "false");
+	printf("}\n");
+	return queue_passed && timers_passed ? 0 : 1;
+}
\ No newline at end of file
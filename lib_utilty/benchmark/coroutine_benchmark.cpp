@@ -0,0 +1,295 @@
+/***********************************************
+*Э̶ʱ׼,ҪC++20,Ҫ,JSON׼.
+*ͬʱNЭ(Ĭ100):ÿЭco_await Wait(start)һCoroutineEvent,
+*ȫ֮ͳÿȴռõڴ(Э֡ĴСͳפڴ);
+*ȻSetEvent,ÿЭco_await SleepForͬһʱ,ͳȫʱĻָٶ.
+*ֱָڶʱ߳кͽ4̵߳ThreadPoolִ.
+*WithTimeout:һЭ̵ȴ¼ڳʱ֮ǰSetEvent,һ볬ʱ.
+*÷: coroutine_benchmark [--waiters N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <exception>
+#include <new>
+#include <thread>
+#include <chrono>
+#include "lib_utility.h"
+#include "timer_coroutine.h"
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#ifndef UTILITY_HAS_COROUTINE
+#error "coroutine_benchmark needs a compiler with C++20 coroutines"
+#endif
+
+namespace {
+
+	std::atomic<unsigned long long> frame_bytes(0);//ǰЭ֡ĴС
+
+	//֮ٹЭ,ʱԶ
+	struct DetachedTask
+	{
+		struct promise_type
+		{
+			DetachedTask get_return_object() { return DetachedTask(); }
+			std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+			std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+
+			static void* operator new(size_t size)
+			{
+				frame_bytes.fetch_add(size, std::memory_order_relaxed);
+				return ::operator new(size);
+			}
+			static void operator delete(void* frame, size_t size)
+			{
+				frame_bytes.fetch_sub(size, std::memory_order_relaxed);
+				::operator delete(frame);
+			}
+		};
+	};
+
+	struct SleepResult
+	{
+		const char* resume_on;
+		size_t waiters;
+		double spawn_ns;//һЭ̲¼
+		double frame_bytes_per_waiter;
+		double rss_bytes_per_waiter;
+		double arm_ns;//SetEvent֮ÿЭָ̻ʱ
+		double resume_per_second;//һһڻָ֮
+		double first_lateness_ms;//һָԵʱӳ
+		size_t late_arms;//ʱʱѾ˵ʱЭ
+	};
+
+	struct TimeoutResult
+	{
+		size_t waiters;
+		size_t signaled;
+		size_t timed_out;
+		double elapsed_ms;
+	};
+
+	//Э̹ļ,һָЭ̼¼ʱ
+	struct SleepShared
+	{
+		utility::CoroutineTimer* timer;
+		utility::CoroutineEvent start;
+		unsigned long long deadline_ns;
+		size_t waiters;
+		std::atomic<size_t> late_arms;
+		std::atomic<size_t> resumed;
+		std::atomic<unsigned long long> first_ns;
+		std::atomic<unsigned long long> last_ns;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	long long GetResidentBytes()
+	{
+#ifdef _WIN32
+		return 0;
+#else
+		FILE* file = fopen("/proc/self/statm", "r");
+		if (file == NULL)
+		{
+			return 0;
+		}
+		long long size = 0, resident = 0;
+		if (fscanf(file, "%lld %lld", &size, &resident) != 2)
+		{
+			resident = 0;
+		}
+		fclose(file);
+		return resident * sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+	DetachedTask Sleeper(SleepShared& shared)
+	{
+		co_await utility::Wait(shared.start);
+
+		unsigned long long now = NowNs();
+		unsigned interval_ms = 0;
+		if (now < shared.deadline_ns)
+		{
+			interval_ms = (unsigned)((shared.deadline_ns - now + 999999) / 1000000);
+		}
+		else
+		{
+			shared.late_arms.fetch_add(1, std::memory_order_relaxed);
+		}
+		co_await utility::SleepFor(*shared.timer, interval_ms);
+
+		size_t resumed = shared.resumed.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (resumed == 1)
+		{
+			shared.first_ns.store(NowNs(), std::memory_order_relaxed);
+		}
+		if (resumed == shared.waiters)
+		{
+			shared.last_ns.store(NowNs(), std::memory_order_release);
+		}
+	}
+
+	SleepResult BenchSleep(size_t waiters, utility::ThreadPool* executor)
+	{
+		SleepResult result = { executor != NULL ? "thread_pool" : "timer_thread", waiters, 0, 0, 0, 0, 0, 0, 0 };
+		utility::CoroutineTimer timer;
+		timer.SetExecutor(executor);
+		timer.StartTimerThread();
+
+		SleepShared shared;
+		shared.timer = &timer;
+		shared.deadline_ns = 0;
+		shared.waiters = waiters;
+		shared.late_arms = 0;
+		shared.resumed = 0;
+		shared.first_ns = 0;
+		shared.last_ns = 0;
+
+		long long rss_before = GetResidentBytes();
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < waiters; i++)
+		{
+			Sleeper(shared);
+		}
+		unsigned long long end = NowNs();
+		result.spawn_ns = (double)(end - start) / waiters;
+		result.frame_bytes_per_waiter = (double)frame_bytes.load(std::memory_order_relaxed) / waiters;
+		result.rss_bytes_per_waiter = (double)(GetResidentBytes() - rss_before) / waiters;
+
+		//Ԥ㹻ȫЭ̵ʱ,Эͬһ̶ȵ
+		shared.deadline_ns = NowNs() + 500000000ULL + (unsigned long long)waiters * 1000ULL;
+		start = NowNs();
+		shared.start.SetEvent();
+		end = NowNs();
+		result.arm_ns = (double)(end - start) / waiters;
+
+		while (shared.last_ns.load(std::memory_order_acquire) == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		unsigned long long first = shared.first_ns.load(std::memory_order_relaxed);
+		unsigned long long last = shared.last_ns.load(std::memory_order_relaxed);
+		result.resume_per_second = last > first ? (double)waiters * 1e9 / (double)(last - first) : 0;
+		result.first_lateness_ms = first > shared.deadline_ns ? (double)(first - shared.deadline_ns) / 1e6 : 0;
+		result.late_arms = shared.late_arms.load(std::memory_order_relaxed);
+
+		//һЭ̼¼ʱ֮Ҫִе
+		while (frame_bytes.load(std::memory_order_acquire) != 0)
+		{
+			std::this_thread::yield();
+		}
+		timer.StopTimerThread();
+		return result;
+	}
+
+	struct TimeoutShared
+	{
+		std::atomic<size_t> signaled;
+		std::atomic<size_t> timed_out;
+	};
+
+	DetachedTask TimeoutWaiter(utility::CoroutineTimer& timer, utility::CoroutineEvent& event, TimeoutShared& shared)
+	{
+		bool signaled = co_await utility::WithTimeout(timer, utility::Wait(event), 200);
+		if (signaled)
+		{
+			shared.signaled.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			shared.timed_out.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	TimeoutResult BenchTimeout(size_t waiters)
+	{
+		TimeoutResult result = { waiters, 0, 0, 0 };
+		utility::CoroutineTimer timer;
+		timer.StartTimerThread();
+		utility::CoroutineEvent signaled_event;
+		utility::CoroutineEvent silent_event;//һֱûź
+		TimeoutShared shared;
+		shared.signaled = 0;
+		shared.timed_out = 0;
+
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < waiters; i++)
+		{
+			TimeoutWaiter(timer, i % 2 == 0 ? signaled_event : silent_event, shared);
+		}
+		signaled_event.SetEvent();
+		while (frame_bytes.load(std::memory_order_acquire) != 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		result.elapsed_ms = (double)(NowNs() - start) / 1e6;
+		result.signaled = shared.signaled.load(std::memory_order_relaxed);
+		result.timed_out = shared.timed_out.load(std::memory_order_relaxed);
+		timer.StopTimerThread();
+		return result;
+	}
+
+	void PrintJson(const SleepResult* sleeps, int sleep_count, const TimeoutResult& timeout)
+	{
+		printf("{\n");
+		printf("  \"benchmark\": \"coroutine_timer\",\n");
+		printf("  \"config\": {\"waiters\": %zu, \"sleep_awaiter_bytes\": %zu, \"wait_awaiter_bytes\": %zu},\n",
+			sleeps[0].waiters, sizeof(utility::SleepAwaiter), sizeof(utility::WaitAwaiter));
+		printf("  \"sleep_for\": [\n");
+		for (int i = 0; i < sleep_count; i++)
+		{
+			const SleepResult& s = sleeps[i];
+			printf("    {\"resume_on\": \"%s\", \"waiters\": %zu, \"spawn_ns_per_waiter\": %.1f, "
+				"\"frame_bytes_per_waiter\": %.1f, \"rss_bytes_per_waiter\": %.1f, \"arm_ns_per_waiter\": %.1f, "
+				"\"resumes_per_second\": %.0f, \"first_lateness_ms\": %.3f, \"late_arms\": %zu}%s\n",
+				s.resume_on, s.waiters, s.spawn_ns, s.frame_bytes_per_waiter, s.rss_bytes_per_waiter, s.arm_ns,
+				s.resume_per_second, s.first_lateness_ms, s.late_arms, i + 1 < sleep_count ? "," : "");
+		}
+		printf("  ],\n");
+		printf("  \"with_timeout\": {\"waiters\": %zu, \"signaled\": %zu, \"timed_out\": %zu, \"elapsed_ms\": %.1f}\n",
+			timeout.waiters, timeout.signaled, timeout.timed_out, timeout.elapsed_ms);
+		printf("}\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t waiters = 1000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--waiters") == 0 && i + 1 < argc)
+		{
+			waiters = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--waiters N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (waiters == 0)
+	{
+		waiters = 1;
+	}
+
+	/*פڴֻڵһβ,֮ͷŵЭ֡ڷлᱻظʹ*/
+	SleepResult sleeps[2];
+	sleeps[0] = BenchSleep(waiters, NULL);
+	utility::ThreadPool pool;
+	pool.StartPool(4);
+	sleeps[1] = BenchSleep(waiters, &pool);
+	pool.StopPool();
+	TimeoutResult timeout = BenchTimeout(waiters / 10 > 0 ? waiters / 10 : 1);
+	PrintJson(sleeps, 2, timeout);
+	return 0;
+}
\ No newline at end of file
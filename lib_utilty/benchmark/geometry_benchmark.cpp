@@ -0,0 +1,206 @@
+/***********************************************
+*ʱּβ,Ҫ,JSON׼,жʱǰ©ʱ1.
+*ÿTimerWheel<̶, һλ, ߼λ, >--timersʱ,ʱָصķΧֲ:
+*network:1ms30s(Ӻʱ);session:1s1(Ự).
+*ʱ䰴̶ȡ,ȡһ֮Լ1000ƽһʱ:
+*insert_ns/cancel_ns:ÿʱȡĺʱ;
+*advance_ns:ƽܺʱ()ڵĶʱƽ;
+*cascades_per_timer:ÿʱƽĴ,ʱΧĶʱ.
+*÷: geometry_benchmark [--timers N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "lib_utility.h"
+
+namespace {
+
+	enum { ADVANCE_STEPS = 1000 };
+
+	struct Node : public utility::TimerWheelHook
+	{
+	};
+
+	struct Workload
+	{
+		const char* name;
+		unsigned long long min_ns;
+		unsigned long long max_ns;
+	};
+
+	struct GeometryResult
+	{
+		double insert_ns;
+		double cancel_ns;
+		double advance_ns;
+		double cascades_per_timer;
+		size_t expired;
+		size_t early;
+		bool ok;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	template <class Wheel>
+	struct CountHandler
+	{
+		Wheel* wheel_;
+		size_t cascades_;
+		size_t expired_;
+		size_t early_;
+
+		void OnCascade(utility::TimerWheelHook*) { cascades_++; }
+		void OnExpire(utility::TimerWheelHook* node)
+		{
+			expired_++;
+			//OnExpireʱǰ̶Ѿ1
+			if (node->expire_tick_ > wheel_->GetCurrentTick() - 1)
+			{
+				early_++;
+			}
+		}
+	};
+
+	template <class Wheel>
+	GeometryResult BenchGeometry(unsigned long long tick_ns, const Workload& workload, size_t timers)
+	{
+		GeometryResult result;
+		memset(&result, 0, sizeof(result));
+		Wheel* wheel = new Wheel(0);
+		std::vector<Node> nodes(timers);
+		unsigned long long last_tick = 0;
+		unsigned seed = 12345;
+		for (size_t i = 0; i < timers; i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			unsigned long long random = ((unsigned long long)seed << 16) ^ (seed >> 8);
+			unsigned long long delay_ns = workload.min_ns + random % (workload.max_ns - workload.min_ns);
+			nodes[i].expire_tick_ = (delay_ns + tick_ns - 1) / tick_ns;
+			last_tick = nodes[i].expire_tick_ > last_tick ? nodes[i].expire_tick_ : last_tick;
+		}
+
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < timers; i++)
+		{
+			wheel->Insert(&nodes[i]);
+		}
+		result.insert_ns = (double)(NowNs() - start) / timers;
+
+		size_t cancels = timers / 2;
+		start = NowNs();
+		for (size_t i = 0; i < cancels; i++)
+		{
+			//timers,ȡĶʱɢڸ
+			wheel->Remove(&nodes[(i * 7919) % timers]);
+		}
+		result.cancel_ns = cancels ? (double)(NowNs() - start) / cancels : 0;
+		size_t remaining = wheel->GetCount();
+
+		CountHandler<Wheel> handler = { wheel, 0, 0, 0 };
+		unsigned long long step = last_tick / ADVANCE_STEPS + 1;
+		start = NowNs();
+		for (unsigned long long tick = step; ; tick += step)
+		{
+			wheel->AdvanceTo(tick < last_tick ? tick : last_tick, handler);
+			if (tick >= last_tick)
+			{
+				break;
+			}
+		}
+		unsigned long long elapsed = NowNs() - start;
+		result.expired = handler.expired_;
+		result.early = handler.early_;
+		result.advance_ns = handler.expired_ ? (double)elapsed / handler.expired_ : 0;
+		result.cascades_per_timer = remaining ? (double)handler.cascades_ / remaining : 0;
+		result.ok = handler.expired_ == remaining && handler.early_ == 0 && wheel->GetCount() == 0;
+		delete wheel;
+		return result;
+	}
+
+	struct Geometry
+	{
+		const char* name;
+		unsigned long long tick_ns;
+		unsigned long long span_ticks;
+		size_t bytes;
+		GeometryResult (*bench)(unsigned long long, const Workload&, size_t);
+	};
+
+	template <unsigned long long TICK_NS, int ROOT_BITS, int LEVEL_BITS, int LEVELS>
+	Geometry MakeGeometry(const char* name)
+	{
+		typedef utility::TimerWheel<TICK_NS, ROOT_BITS, LEVEL_BITS, LEVELS> Wheel;
+		Geometry geometry = { name, TICK_NS, Wheel::MAX_SPAN + 1, sizeof(Wheel), BenchGeometry<Wheel> };
+		return geometry;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t timers = 1000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc)
+		{
+			timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--timers N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (timers == 0)
+	{
+		timers = 1;
+	}
+
+	const unsigned long long MS = 1000000ULL;
+	const unsigned long long SECOND = 1000000000ULL;
+	const Workload workloads[] = {
+		{ "network", MS, 30 * SECOND },
+		{ "session", SECOND, 86400 * SECOND },
+	};
+	//TimerManagertimer_wheel.hʹõ1ms_8_6_4
+	const Geometry geometries[] = {
+		MakeGeometry<MS, 8, 6, 4>("1ms_8_6_4"),
+		MakeGeometry<MS, 8, 4, 3>("1ms_8_4_3"),
+		MakeGeometry<MS, 6, 6, 3>("1ms_6_6_3"),
+		MakeGeometry<MS, 10, 6, 3>("1ms_10_6_3"),
+		MakeGeometry<MS, 16, 6, 2>("1ms_16_6_2"),
+		MakeGeometry<10 * MS, 8, 6, 3>("10ms_8_6_3"),
+		MakeGeometry<SECOND, 6, 6, 3>("1s_6_6_3"),
+	};
+	const int workload_count = sizeof(workloads) / sizeof(workloads[0]);
+	const int geometry_count = sizeof(geometries) / sizeof(geometries[0]);
+
+	bool all_ok = true;
+	printf("{\n");
+	printf("  \"benchmark\": \"wheel_geometry\",\n");
+	printf("  \"timers\": %zu,\n", timers);
+	printf("  \"results\": [\n");
+	for (int w = 0; w < workload_count; w++)
+	{
+		for (int g = 0; g < geometry_count; g++)
+		{
+			const Geometry& geometry = geometries[g];
+			GeometryResult result = geometry.bench(geometry.tick_ns, workloads[w], timers);
+			all_ok = all_ok && result.ok;
+			bool last = w == workload_count - 1 && g == geometry_count - 1;
+			printf("    {\"workload\": \"%s\", \"geometry\": \"%s\", \"span_ticks\": %llu, \"bytes\": %zu, "
+				"\"insert_ns\": %.1f, \"cancel_ns\": %.1f, \"advance_ns\": %.1f, \"cascades_per_timer\": %.2f, "
+				"\"expired\": %zu, \"early\": %zu, \"ok\": %s}%s\n",
+				workloads[w].name, geometry.name, geometry.span_ticks, geometry.bytes,
+				result.insert_ns, result.cancel_ns, result.advance_ns, result.cascades_per_timer,
+				result.expired, result.early, result.ok ? "true" : "false", last ? "" : ",");
+			fflush(stdout);
+		}
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return all_ok ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+/***********************************************
+*˫ܲ,Ҫ,JSON׼.
+*ȽDoubleLinkedList<int>(±ڵ)DoubleLinkedList<int, 16>(չ)std::list<int>,
+*ԪظΪ10^3--max-size(Ĭ10^7):
+*insert:β0..n-1,ÿεĺʱ;
+*find/delete:ҺɾԪ,ÿζҪͷɨ,n,ʹÿɨԪԼΪ10^8.
+*÷: list_benchmark [--max-size N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include "lib_utility.h"
+
+namespace {
+
+	typedef utility::DoubleLinkedList<int> IndexList;
+	typedef utility::DoubleLinkedList<int, 16> UnrolledList;
+
+	//std::listDoubleLinkedListĽӿ
+	class StdList
+	{
+	public:
+		bool InsertNode(const int& value)
+		{
+			list_.push_back(value);
+			return true;
+		}
+
+		bool FindNode(const int& value) const
+		{
+			return std::find(list_.begin(), list_.end(), value) != list_.end();
+		}
+
+		bool DeleteNode(const int& value)
+		{
+			std::list<int>::iterator itr = std::find(list_.begin(), list_.end(), value);
+			if (itr == list_.end())
+			{
+				return false;
+			}
+			list_.erase(itr);
+			return true;
+		}
+
+		int GetSize() const { return (int)list_.size(); }
+
+	private:
+		std::list<int> list_;
+	};
+
+	struct ListResult
+	{
+		double insert_ns;
+		double find_ns;
+		double delete_ns;
+		size_t lookups;
+		bool ok;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	template <class List>
+	ListResult BenchList(int size, const std::vector<int>& keys)
+	{
+		ListResult result = { 0, 0, 0, keys.size(), true };
+		List* list = new List();
+		unsigned long long start = NowNs();
+		for (int i = 0; i < size; i++)
+		{
+			list->InsertNode(i);
+		}
+		result.insert_ns = (double)(NowNs() - start) / size;
+
+		size_t found = 0;
+		start = NowNs();
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			found += list->FindNode(keys[i]) ? 1 : 0;
+		}
+		result.find_ns = (double)(NowNs() - start) / keys.size();
+
+		size_t deleted = 0;
+		start = NowNs();
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			deleted += list->DeleteNode(keys[i]) ? 1 : 0;
+		}
+		result.delete_ns = (double)(NowNs() - start) / keys.size();
+		result.ok = found == keys.size() && deleted == keys.size() && list->GetSize() == size - (int)keys.size();
+		delete list;
+		return result;
+	}
+
+	void PrintResult(const char* list, int size, const ListResult& result, bool last)
+	{
+		printf("    {\"list\": \"%s\", \"size\": %d, \"lookups\": %zu, \"insert_ns\": %.1f, \"find_ns\": %.0f, \"delete_ns\": %.0f, \"ok\": %s}%s\n",
+			list, size, result.lookups, result.insert_ns, result.find_ns, result.delete_ns, result.ok ? "true" : "false", last ? "" : ",");
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int max_size = 10000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc)
+		{
+			max_size = atoi(argv[++i]);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--max-size N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("{\n");
+	printf("  \"benchmark\": \"double_linked_list\",\n");
+	printf("  \"results\": [\n");
+	for (int size = 1000; size <= max_size; size *= 10)
+	{
+		//ظԪ,ÿҵɾ
+		size_t lookups = (size_t)(100000000LL / size);
+		lookups = std::max<size_t>(10, std::min<size_t>(lookups, (size_t)size / 2));
+		std::vector<int> keys(size);
+		for (int i = 0; i < size; i++)
+		{
+			keys[i] = i;
+		}
+		unsigned seed = 12345;
+		for (size_t i = 0; i < lookups; i++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			std::swap(keys[i], keys[i + (seed >> 8) % (size - i)]);
+		}
+		keys.resize(lookups);
+
+		bool last = (long long)size * 10 > max_size;
+		PrintResult("DoubleLinkedList", size, BenchList<IndexList>(size, keys), false);
+		PrintResult("DoubleLinkedList<16>", size, BenchList<UnrolledList>(size, keys), false);
+		PrintResult("std::list", size, BenchList<StdList>(size, keys), last);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
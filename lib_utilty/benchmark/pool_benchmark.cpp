@@ -0,0 +1,224 @@
+/***********************************************
+*ʱػ,Ҫ,JSON׼.
+*滻ȫoperator newͳƷ,Ƚÿ+ֹͣʱķͺʱ:
+*unpooled:ػ֮ǰ,TimerTaskϵͳѷ,صǲ32ֽڵstd::function;
+*pooled:ڵ,TimerTaskFixedSizePool,صֱӷInlineFunction;
+*timer_thread:TimerThread::SetATimer/StopATimer,Ͷ,ͳƵ̵ķ.
+*ÿ--liveʱȫֹͣ,--ops.
+*÷: pool_benchmark [--live N] [--ops N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include "lib_utility.h"
+
+namespace {
+	std::atomic<unsigned long long> g_allocations(0);
+}
+
+void* operator new(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	void* block = malloc(size == 0 ? 1 : size);
+	if (block == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	free(block);
+}
+
+namespace {
+
+	struct PoolResult
+	{
+		double allocations_per_op;
+		double ns_per_op;
+	};
+
+	//ص,32ֽ,std::functionڲ
+	struct Payload
+	{
+		unsigned long long values[4];
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	//ػ֮ǰ:TimerTaskƹoperator new,ϵͳѷ
+	utility::TimerTask* NewUnpooledTask(const Payload& payload, unsigned long long* sink)
+	{
+		void* block = ::operator new(sizeof(utility::TimerTask));
+		utility::TimerTask* timer_task = ::new (block) utility::TimerTask();
+		std::function<void()> callback = [payload, sink]() { *sink += payload.values[0]; };
+		timer_task->SetTimerCallback(utility::TimerCallback(std::move(callback)));
+		timer_task->SetTimerTask(NULL, 1000, utility::ONCE);
+		return timer_task;
+	}
+
+	void DeleteUnpooledTask(utility::TimerTask* timer_task)
+	{
+		timer_task->~TimerTask();
+		::operator delete((void*)timer_task);
+	}
+
+	utility::TimerTask* NewPooledTask(const Payload& payload, unsigned long long* sink)
+	{
+		utility::TimerTask* timer_task = new utility::TimerTask();
+		timer_task->SetTimerCallback(utility::TimerCallback([payload, sink]() { *sink += payload.values[0]; }));
+		timer_task->SetTimerTask(NULL, 1000, utility::ONCE);
+		return timer_task;
+	}
+
+	void DeletePooledTask(utility::TimerTask* timer_task)
+	{
+		delete timer_task;
+	}
+
+	template <class NewTask, class DeleteTask>
+	PoolResult BenchManager(NewTask new_task, DeleteTask delete_task, size_t live, size_t ops)
+	{
+		PoolResult result = { 0, 0 };
+		utility::TimerManager manager(1);
+		std::vector<utility::TimerTask*> tasks(live);
+		Payload payload = { { 1, 2, 3, 4 } };
+		unsigned long long sink = 0;
+		size_t rounds = (ops + live - 1) / live;
+
+		//һ,óغvector
+		for (size_t i = 0; i < live; i++)
+		{
+			tasks[i] = new_task(payload, &sink);
+			manager.AddTimer(tasks[i]);
+		}
+		for (size_t i = 0; i < live; i++)
+		{
+			manager.RemoveTimer(tasks[i]);
+			delete_task(tasks[i]);
+		}
+
+		unsigned long long allocations = g_allocations.load();
+		unsigned long long start = NowNs();
+		for (size_t r = 0; r < rounds; r++)
+		{
+			for (size_t i = 0; i < live; i++)
+			{
+				tasks[i] = new_task(payload, &sink);
+				manager.AddTimer(tasks[i]);
+			}
+			for (size_t i = 0; i < live; i++)
+			{
+				manager.RemoveTimer(tasks[i]);
+				delete_task(tasks[i]);
+			}
+		}
+		unsigned long long elapsed = NowNs() - start;
+		size_t total = rounds * live;
+		result.allocations_per_op = (double)(g_allocations.load() - allocations) / total;
+		result.ns_per_op = (double)elapsed / total;
+		return result;
+	}
+
+	PoolResult BenchTimerThread(size_t live, size_t ops)
+	{
+		PoolResult result = { 0, 0 };
+		utility::TimerThread timer_thread(1);
+		timer_thread.StartTimerThread();
+		std::vector<utility::TimerHandle> handles(live);
+		Payload payload = { { 1, 2, 3, 4 } };
+		std::atomic<unsigned long long> sink(0);
+		size_t rounds = (ops + live - 1) / live;
+
+		unsigned long long allocations = g_allocations.load();
+		unsigned long long start = NowNs();
+		for (size_t r = 0; r < rounds + 1; r++)
+		{
+			if (r == 1)
+			{
+				//һֻԤ
+				allocations = g_allocations.load();
+				start = NowNs();
+			}
+			for (size_t i = 0; i < live; i++)
+			{
+				handles[i] = timer_thread.SetATimer([payload, &sink]() { sink.fetch_add(payload.values[0]); }, 1000, utility::ONCE);
+			}
+			for (size_t i = 0; i < live; i++)
+			{
+				timer_thread.StopATimer(handles[i]);
+			}
+		}
+		while (timer_thread.GetTimerCount() != 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		unsigned long long elapsed = NowNs() - start;
+		size_t total = rounds * live;
+		result.allocations_per_op = (double)(g_allocations.load() - allocations) / total;
+		result.ns_per_op = (double)elapsed / total;
+		timer_thread.StopTimerThread();
+		return result;
+	}
+
+	void PrintResult(const char* mode, const PoolResult& result, bool last)
+	{
+		printf("    {\"mode\": \"%s\", \"allocations_per_arm_cancel\": %.3f, \"ns_per_arm_cancel\": %.1f}%s\n",
+			mode, result.allocations_per_op, result.ns_per_op, last ? "" : ",");
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t live = 10000;
+	size_t ops = 2000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--live") == 0 && i + 1 < argc)
+		{
+			live = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+		{
+			ops = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--live N] [--ops N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (live == 0)
+	{
+		live = 1;
+	}
+
+	printf("{\n");
+	printf("  \"benchmark\": \"timer_task_pool\",\n");
+	printf("  \"live_timers\": %zu,\n", live);
+	printf("  \"ops\": %zu,\n", ops);
+	printf("  \"results\": [\n");
+	PrintResult("unpooled", BenchManager(NewUnpooledTask, DeleteUnpooledTask, live, ops), false);
+	PrintResult("pooled", BenchManager(NewPooledTask, DeletePooledTask, live, ops), false);
+	PrintResult("timer_thread", BenchTimerThread(live, ops), true);
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
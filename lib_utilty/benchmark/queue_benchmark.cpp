@@ -0,0 +1,210 @@
+/***********************************************
+*ζܲ,Ҫ,JSON׼.
+*߰ʱдԪ,߳ʱӳ(ÿ16Ԫزһ),ͳÿӴӳٵp50/p99:
+*CycleQueue(SPSC):11;
+*MpmcCycleQueue:1/12/24/48/81/44/1/;
+*std::mutex+std::dequeΪ,MPMCʹͬ.
+*1024,ÿ鹲--itemsԪ(Ĭ4*10^6).
+*÷: queue_benchmark [--items N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include "lib_utility.h"
+
+namespace {
+
+	enum { QUEUE_CAPACITY = 1024, SAMPLE_MASK = 15 };
+
+	typedef utility::CycleQueue<unsigned long long, QUEUE_CAPACITY> SpscQueue;
+	typedef utility::MpmcCycleQueue<unsigned long long, QUEUE_CAPACITY> MpmcQueue;
+
+	//:н
+	class LockedQueue
+	{
+	public:
+		bool Push(const unsigned long long& value)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (queue_.size() >= QUEUE_CAPACITY)
+			{
+				return false;
+			}
+			queue_.push_back(value);
+			return true;
+		}
+
+		bool Pop(unsigned long long& value)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (queue_.empty())
+			{
+				return false;
+			}
+			value = queue_.front();
+			queue_.pop_front();
+			return true;
+		}
+
+	private:
+		std::mutex mutex_;
+		std::deque<unsigned long long> queue_;
+	};
+
+	struct QueueResult
+	{
+		double ops_per_second;
+		double p50_ns;
+		double p99_ns;
+		bool count_ok;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	/*ÿitems/producersԪ,Ԫʱ(Ϊ0);
+	*߽ٷconsumers0,ȡ0ʱ˳*/
+	template <class Queue>
+	QueueResult BenchQueue(int producers, int consumers, size_t items)
+	{
+		QueueResult result = { 0, 0, 0, false };
+		Queue* queue = new Queue();
+		size_t per_producer = items / producers;
+		std::vector<std::vector<unsigned long long> > samples(consumers);
+		std::vector<size_t> popped(consumers, 0);
+
+		std::vector<std::thread> consumer_threads;
+		for (int c = 0; c < consumers; c++)
+		{
+			consumer_threads.push_back(std::thread([queue, &samples, &popped, c, items, consumers]() {
+				std::vector<unsigned long long>& local = samples[c];
+				local.reserve(items / consumers / (SAMPLE_MASK + 1) + 16);
+				size_t count = 0;
+				for (;;)
+				{
+					unsigned long long stamp = 0;
+					if (!queue->Pop(stamp))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					if (stamp == 0)
+					{
+						break;
+					}
+					if ((count & SAMPLE_MASK) == 0)
+					{
+						local.push_back(NowNs() - stamp);
+					}
+					count++;
+				}
+				popped[c] = count;
+			}));
+		}
+
+		unsigned long long start = NowNs();
+		std::vector<std::thread> producer_threads;
+		for (int p = 0; p < producers; p++)
+		{
+			producer_threads.push_back(std::thread([queue, per_producer]() {
+				for (size_t i = 0; i < per_producer; i++)
+				{
+					unsigned long long stamp = NowNs();
+					while (!queue->Push(stamp))
+					{
+						std::this_thread::yield();
+					}
+				}
+			}));
+		}
+		for (size_t i = 0; i < producer_threads.size(); i++)
+		{
+			producer_threads[i].join();
+		}
+		for (int c = 0; c < consumers; c++)
+		{
+			while (!queue->Push(0))
+			{
+				std::this_thread::yield();
+			}
+		}
+		for (size_t i = 0; i < consumer_threads.size(); i++)
+		{
+			consumer_threads[i].join();
+		}
+		unsigned long long elapsed = NowNs() - start;
+		delete queue;
+
+		size_t total = 0;
+		std::vector<unsigned long long> latency;
+		for (int c = 0; c < consumers; c++)
+		{
+			total += popped[c];
+			latency.insert(latency.end(), samples[c].begin(), samples[c].end());
+		}
+		result.count_ok = total == per_producer * producers;
+		result.ops_per_second = elapsed ? total * 1e9 / elapsed : 0;
+		if (!latency.empty())
+		{
+			std::sort(latency.begin(), latency.end());
+			result.p50_ns = (double)latency[(latency.size() - 1) / 2];
+			result.p99_ns = (double)latency[(size_t)((latency.size() - 1) * 0.99)];
+		}
+		return result;
+	}
+
+	void PrintResult(const char* queue, int producers, int consumers, const QueueResult& result, bool last)
+	{
+		printf("    {\"queue\": \"%s\", \"producers\": %d, \"consumers\": %d, \"ops_per_second\": %.0f, "
+			"\"latency_p50_ns\": %.0f, \"latency_p99_ns\": %.0f, \"count_ok\": %s}%s\n",
+			queue, producers, consumers, result.ops_per_second, result.p50_ns, result.p99_ns,
+			result.count_ok ? "true" : "false", last ? "" : ",");
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t items = 4000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--items") == 0 && i + 1 < argc)
+		{
+			items = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--items N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const int shapes[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 }, { 8, 8 }, { 1, 4 }, { 4, 1 } };
+	const int count = sizeof(shapes) / sizeof(shapes[0]);
+	printf("{\n");
+	printf("  \"benchmark\": \"ring_queues\",\n");
+	printf("  \"hardware_concurrency\": %u,\n", std::thread::hardware_concurrency());
+	printf("  \"capacity\": %d,\n", (int)QUEUE_CAPACITY);
+	printf("  \"items\": %zu,\n", items);
+	printf("  \"results\": [\n");
+	PrintResult("spsc", 1, 1, BenchQueue<SpscQueue>(1, 1, items), false);
+	for (int i = 0; i < count; i++)
+	{
+		PrintResult("mpmc", shapes[i][0], shapes[i][1], BenchQueue<MpmcQueue>(shapes[i][0], shapes[i][1], items), false);
+	}
+	for (int i = 0; i < count; i++)
+	{
+		PrintResult("locked", shapes[i][0], shapes[i][1], BenchQueue<LockedQueue>(shapes[i][0], shapes[i][1], items), i + 1 == count);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
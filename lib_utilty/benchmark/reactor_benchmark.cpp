@@ -0,0 +1,516 @@
+/***********************************************
+*Ӧ׼(Linux),Ҫ,JSON׼.
+*˺Ϳͻ˸һ߳һReactor,ͨ127.0.0.1NTCP:
+*һʱĻ,ͳÿԵϢӳ;
+*Ȼһÿidle_ms/4һαϢ,һ벻ٷ,ÿһгʱʱ,
+*յʱƺ.ͳƳʱرյʱԿ޵ӳ,Լ˵ĻѴtimerfdĴ.
+*ÿڱռfd,fdʱ޲,еfd_limitedΪtrue.
+*пгʱȿ紥ʱ1.
+*÷: reactor_benchmark [--connections N[,N...]] [--echo-ms N] [--idle-ms N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "reactor.h"
+#include "timer_stats.h"
+
+namespace {
+
+	struct EchoResult
+	{
+		size_t requested;
+		size_t connections;
+		bool fd_limited;
+		double setup_ms;
+		double echo_msgs_per_second;
+		unsigned long long echo_p50_us;
+		unsigned long long echo_p99_us;
+		size_t idle_timeouts;
+		size_t expected_idle_timeouts;
+		size_t keepalive_closed;//ͱӱرյĸ
+		unsigned long long lateness_p50_us;
+		unsigned long long lateness_p99_us;
+		unsigned long long lateness_max_us;
+		size_t early_timeouts;//ȿ紥ĳʱ,Ϊ0ʱ1
+		unsigned long long server_wakeups;
+		unsigned long long server_timer_arms;
+	};
+
+	enum { MESSAGE_SIZE = 16 };
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	void SetNonBlocking(int fd)
+	{
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+	}
+
+	//fdߵӲ,ؿʹõfd
+	size_t RaiseFdLimit()
+	{
+		rlimit limit;
+		if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+		{
+			return 1024;
+		}
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+		getrlimit(RLIMIT_NOFILE, &limit);
+		return (size_t)limit.rlim_cur;
+	}
+
+	class EchoServer;
+
+	//:յ,гidle_msʱر
+	class ServerConnection : public utility::IoHandler
+	{
+	public:
+		ServerConnection(EchoServer& server, int fd);
+		void OnIoEvents(int fd, unsigned events);
+
+	private:
+		void OnIdle();
+		void Close();
+
+		EchoServer& server_;
+		int fd_;
+		unsigned long long last_active_ns_;
+		Timer idle_timer_;
+	};
+
+	class EchoServer : public utility::IoHandler
+	{
+	public:
+		explicit EchoServer(unsigned idle_ms)
+			: listen_fd_(-1), idle_ms_(idle_ms), accepted_(0), idle_timeouts_(0), early_timeouts_(0)
+		{
+		}
+
+		bool Open()
+		{
+			listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+			if (listen_fd_ < 0 || !reactor_.Open())
+			{
+				return false;
+			}
+			sockaddr_in addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			socklen_t length = sizeof(addr);
+			if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd_, SOMAXCONN) != 0 ||
+				getsockname(listen_fd_, (sockaddr*)&addr, &length) != 0)
+			{
+				return false;
+			}
+			port_ = addr.sin_port;
+			return reactor_.AddFd(listen_fd_, EPOLLIN, this);
+		}
+
+		void OnIoEvents(int, unsigned)
+		{
+			for (;;)
+			{
+				int conn_fd = accept4(listen_fd_, NULL, NULL, SOCK_NONBLOCK);
+				if (conn_fd < 0)
+				{
+					break;
+				}
+				int one = 1;
+				setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+				ServerConnection* connection = new ServerConnection(*this, conn_fd);
+				reactor_.AddFd(conn_fd, EPOLLIN, connection);
+				accepted_.fetch_add(1, std::memory_order_release);
+			}
+		}
+
+		void RecordTimeout(unsigned long long deadline_ns)
+		{
+			unsigned long long now = NowNs();
+			idle_timeouts_++;
+			if (now < deadline_ns)
+			{
+				early_timeouts_++;
+				lateness_ns_.Record(0);
+			}
+			else
+			{
+				lateness_ns_.Record(now - deadline_ns);
+			}
+		}
+
+		utility::Reactor reactor_;
+		int listen_fd_;
+		unsigned short port_;
+		unsigned idle_ms_;
+		std::atomic<size_t> accepted_;
+		//ֻڷ߳޸,֮߳̽ȡ
+		size_t idle_timeouts_;
+		size_t early_timeouts_;
+		utility::StatsHistogram lateness_ns_;
+	};
+
+	ServerConnection::ServerConnection(EchoServer& server, int fd)
+		: server_(server), fd_(fd), last_active_ns_(NowNs()), idle_timer_(server.reactor_.GetTimerManager())
+	{
+		idle_timer_.Start([this]() { OnIdle(); }, server_.idle_ms_, Timer::ONCE);
+	}
+
+	void ServerConnection::OnIoEvents(int, unsigned)
+	{
+		char buffer[4096];
+		for (;;)
+		{
+			ssize_t size = read(fd_, buffer, sizeof(buffer));
+			if (size > 0)
+			{
+				if (write(fd_, buffer, size) != size)
+				{
+					//ϢСÿֻһδԵϢ,ͻ
+				}
+				last_active_ns_ = NowNs();
+				idle_timer_.Reschedule(server_.idle_ms_, true);
+				continue;
+			}
+			if (size == 0 || errno != EAGAIN)
+			{
+				Close();
+			}
+			return;
+		}
+	}
+
+	void ServerConnection::OnIdle()
+	{
+		server_.RecordTimeout(last_active_ns_ + server_.idle_ms_ * 1000000ULL);
+		Close();
+	}
+
+	void ServerConnection::Close()
+	{
+		server_.reactor_.RemoveFd(fd_);
+		close(fd_);
+		delete this;//ʱʱֹͣ
+	}
+
+	//ͻ:Խ׶յظͷһ,׶ɶʱڷ
+	class ClientConnection : public utility::IoHandler
+	{
+	public:
+		ClientConnection(utility::Reactor& reactor, int fd, std::vector<ClientConnection*>& closed)
+			: reactor_(reactor), fd_(fd), echoing_(false), keepalive_timer_(reactor.GetTimerManager()), closed_(closed)
+		{
+		}
+
+		void Send()
+		{
+			char message[MESSAGE_SIZE] = { 0 };
+			unsigned long long now = NowNs();
+			memcpy(message, &now, sizeof(now));
+			if (write(fd_, message, sizeof(message)) != (ssize_t)sizeof(message))
+			{
+				//ͬ,ͻ
+			}
+		}
+
+		void OnIoEvents(int, unsigned)
+		{
+			char buffer[4096];
+			for (;;)
+			{
+				ssize_t size = read(fd_, buffer, sizeof(buffer));
+				if (size > 0)
+				{
+					unsigned long long sent = 0;
+					memcpy(&sent, buffer, sizeof(sent));
+					if (echoing_)
+					{
+						latency_ns_->Record(NowNs() - sent);
+						(*echoed_)++;
+						Send();
+					}
+					continue;
+				}
+				if (size == 0 || errno != EAGAIN)
+				{
+					keepalive_timer_.Stop();
+					reactor_.RemoveFd(fd_);
+					close(fd_);
+					fd_ = -1;
+					closed_.push_back(this);
+				}
+				return;
+			}
+		}
+
+		void StartEcho(utility::StatsHistogram* latency_ns, unsigned long long* echoed)
+		{
+			latency_ns_ = latency_ns;
+			echoed_ = echoed;
+			echoing_ = true;
+			Send();
+		}
+
+		void StopEcho() { echoing_ = false; }
+
+		void StartKeepalive(unsigned interval_ms)
+		{
+			keepalive_timer_.Start([this]() { Send(); }, interval_ms, Timer::CIRCLE);
+		}
+
+		void Close()
+		{
+			keepalive_timer_.Stop();
+			if (fd_ >= 0)
+			{
+				reactor_.RemoveFd(fd_);
+				close(fd_);
+				fd_ = -1;
+			}
+		}
+
+		bool IsClosed() const { return fd_ < 0; }
+
+	private:
+		utility::Reactor& reactor_;
+		int fd_;
+		bool echoing_;
+		Timer keepalive_timer_;
+		utility::StatsHistogram* latency_ns_;
+		unsigned long long* echoed_;
+		std::vector<ClientConnection*>& closed_;
+	};
+
+	//ͻ˷Ӧduration_ms,ÿȴ10ms
+	void RunFor(utility::Reactor& reactor, unsigned duration_ms)
+	{
+		unsigned long long end = NowNs() + duration_ms * 1000000ULL;
+		while (NowNs() < end)
+		{
+			reactor.RunOnce(10);
+		}
+	}
+
+	EchoResult BenchEcho(size_t requested, size_t max_connections, unsigned echo_ms, unsigned idle_ms)
+	{
+		EchoResult result;
+		memset(&result, 0, sizeof(result));
+		result.requested = requested;
+		result.connections = requested < max_connections ? requested : max_connections;
+		result.fd_limited = result.connections < requested;
+		size_t count = result.connections;
+
+		EchoServer server(idle_ms);
+		utility::Reactor client;
+		if (!server.Open() || !client.Open())
+		{
+			return result;
+		}
+		std::thread server_thread([&server]() { server.reactor_.RunLoop(); });
+
+		//,ȷ˽һһ,ⳬ
+		std::vector<ClientConnection*> connections;
+		std::vector<ClientConnection*> closed;
+		sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = server.port_;
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			int fd = socket(AF_INET, SOCK_STREAM, 0);
+			if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+			{
+				if (fd >= 0)
+				{
+					close(fd);
+				}
+				break;
+			}
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			SetNonBlocking(fd);
+			ClientConnection* connection = new ClientConnection(client, fd, closed);
+			client.AddFd(fd, EPOLLIN, connection);
+			connections.push_back(connection);
+			if (connections.size() % 1000 == 0)
+			{
+				while (server.accepted_.load(std::memory_order_acquire) < connections.size())
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+		while (server.accepted_.load(std::memory_order_acquire) < connections.size())
+		{
+			std::this_thread::yield();
+		}
+		count = connections.size();
+		result.connections = count;
+		result.setup_ms = (double)(NowNs() - start) / 1e6;
+
+		//:ÿʼһϢ·
+		utility::StatsHistogram latency_ns;
+		unsigned long long echoed = 0;
+		start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			connections[i]->StartEcho(&latency_ns, &echoed);
+		}
+		RunFor(client, echo_ms);
+		double elapsed = (double)(NowNs() - start) / 1e9;
+		for (size_t i = 0; i < count; i++)
+		{
+			connections[i]->StopEcho();
+		}
+		result.echo_msgs_per_second = elapsed > 0 ? (double)echoed / elapsed : 0;
+		utility::HistogramSnapshot latency;
+		latency.Add(latency_ns);
+		result.echo_p50_us = latency.GetPercentile(50) / 1000;
+		result.echo_p99_us = latency.GetPercentile(99) / 1000;
+		//껹·ϵĻظ
+		RunFor(client, 100);
+
+		//:żӱ,Ӳٷ,ȴʱر
+		for (size_t i = 0; i < count; i += 2)
+		{
+			connections[i]->StartKeepalive(idle_ms / 4 > 0 ? idle_ms / 4 : 1);
+		}
+		result.expected_idle_timeouts = count / 2;
+		unsigned long long deadline = NowNs() + idle_ms * 3000000ULL;
+		while (closed.size() < result.expected_idle_timeouts && NowNs() < deadline)
+		{
+			client.RunOnce(10);
+		}
+		for (size_t i = 0; i < count; i += 2)
+		{
+			if (connections[i]->IsClosed())
+			{
+				result.keepalive_closed++;
+			}
+		}
+
+		//رտͻ,˿EOF֮رԼһ
+		for (size_t i = 0; i < count; i++)
+		{
+			connections[i]->Close();
+			delete connections[i];
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		server.reactor_.Stop();
+		server_thread.join();
+
+		result.idle_timeouts = server.idle_timeouts_;
+		result.early_timeouts = server.early_timeouts_;
+		utility::HistogramSnapshot lateness;
+		lateness.Add(server.lateness_ns_);
+		result.lateness_p50_us = lateness.GetPercentile(50) / 1000;
+		result.lateness_p99_us = lateness.GetPercentile(99) / 1000;
+		result.lateness_max_us = lateness.GetMax() / 1000;
+		result.server_wakeups = server.reactor_.GetWakeupCount();
+		result.server_timer_arms = server.reactor_.GetTimerArmCount();
+		close(server.listen_fd_);
+		return result;
+	}
+
+	void PrintJson(const std::vector<EchoResult>& results, unsigned echo_ms, unsigned idle_ms)
+	{
+		printf("{\n");
+		printf("  \"benchmark\": \"reactor_echo\",\n");
+		printf("  \"config\": {\"echo_ms\": %u, \"idle_ms\": %u, \"message_bytes\": %d},\n", echo_ms, idle_ms, (int)MESSAGE_SIZE);
+		printf("  \"results\": [\n");
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const EchoResult& r = results[i];
+			printf("    {\"requested\": %zu, \"connections\": %zu, \"fd_limited\": %s, \"setup_ms\": %.1f, "
+				"\"echo_msgs_per_second\": %.0f, \"echo_p50_us\": %llu, \"echo_p99_us\": %llu, "
+				"\"idle_timeouts\": %zu, \"expected_idle_timeouts\": %zu, \"keepalive_closed\": %zu, "
+				"\"idle_lateness_p50_us\": %llu, \"idle_lateness_p99_us\": %llu, \"idle_lateness_max_us\": %llu, "
+				"\"early_timeouts\": %zu, \"server_wakeups\": %llu, \"server_timer_arms\": %llu}%s\n",
+				r.requested, r.connections, r.fd_limited ? "true" : "false", r.setup_ms,
+				r.echo_msgs_per_second, r.echo_p50_us, r.echo_p99_us,
+				r.idle_timeouts, r.expected_idle_timeouts, r.keepalive_closed,
+				r.lateness_p50_us, r.lateness_p99_us, r.lateness_max_us,
+				r.early_timeouts, r.server_wakeups, r.server_timer_arms, i + 1 < results.size() ? "," : "");
+		}
+		printf("  ]\n");
+		printf("}\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<size_t> counts;
+	unsigned echo_ms = 2000;
+	unsigned idle_ms = 1000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc)
+		{
+			char* text = argv[++i];
+			while (*text != '\0')
+			{
+				counts.push_back((size_t)strtoull(text, &text, 10));
+				if (*text == ',')
+				{
+					text++;
+				}
+			}
+		}
+		else if (strcmp(argv[i], "--echo-ms") == 0 && i + 1 < argc)
+		{
+			echo_ms = (unsigned)strtoul(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--idle-ms") == 0 && i + 1 < argc)
+		{
+			idle_ms = (unsigned)strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--connections N[,N...]] [--echo-ms N] [--idle-ms N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (counts.empty())
+	{
+		counts.push_back(10000);
+		counts.push_back(100000);
+	}
+
+	//ÿfd,һЩepollͱ׼
+	size_t fd_limit = RaiseFdLimit();
+	size_t max_connections = fd_limit > 128 ? (fd_limit - 128) / 2 : 1;
+	std::vector<EchoResult> results;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		results.push_back(BenchEcho(counts[i], max_connections, echo_ms, idle_ms));
+	}
+	PrintJson(results, echo_ms, idle_ms);
+
+	//ڿ̶ȡ,гʱӦǰ
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		if (results[i].early_timeouts != 0)
+		{
+			fprintf(stderr, "idle timeouts fired before their deadline\n");
+			return 1;
+		}
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+/***********************************************
+*ѭʱ·ķ,Ҫ,JSON׼,зʱ1.
+*滻ȫoperator newͳƷ,--timers1msCIRCLEʱһֱDetectTimers,
+*ÿεںһ·ʱ(),ͳ--firesδڼÿ·ķ:
+*utility_wheel/utility_heap:utility::TimerManager,صTimerTaskInlineFunction;
+*timer_wheel:timer_wheel.hTimer.
+*ÿʱȴһΪԤ,Ԥڼķ(DetectTimersڲ).
+*÷: rearm_benchmark [--timers N] [--fires N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include "lib_utility.h"
+#include "timer_wheel.h"
+
+namespace {
+	std::atomic<unsigned long long> g_allocations(0);
+}
+
+void* operator new(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	void* block = malloc(size == 0 ? 1 : size);
+	if (block == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	free(block);
+}
+
+namespace {
+
+	enum { INTERVAL_MS = 1 };
+
+	struct RearmResult
+	{
+		const char* mode;
+		unsigned long long fires;
+		unsigned long long allocations;
+	};
+
+	//firedﵽtarget,ʱ䰴,μ֮óCPU
+	template <class Manager>
+	void DriveUntil(Manager& manager, const unsigned long long& fired, unsigned long long target)
+	{
+		while (fired < target)
+		{
+			manager.DetectTimers();
+			std::this_thread::yield();
+		}
+	}
+
+	RearmResult BenchUtility(utility::TimerQueuePolicy policy, size_t timers, unsigned long long fires)
+	{
+		RearmResult result = { policy == utility::TIMER_QUEUE_HEAP ? "utility_heap" : "utility_wheel", 0, 0 };
+		utility::TimerManager manager(1);
+		manager.SetQueuePolicy(policy);
+		std::vector<utility::TimerTask*> tasks(timers);
+		unsigned long long fired = 0;
+		for (size_t i = 0; i < timers; i++)
+		{
+			tasks[i] = new utility::TimerTask();
+			tasks[i]->SetTimerCallback(utility::TimerCallback([&fired]() { fired++; }));
+			tasks[i]->SetTimerTask(NULL, INTERVAL_MS, utility::CIRCLE);
+			manager.AddTimer(tasks[i]);
+		}
+		DriveUntil(manager, fired, timers);
+
+		unsigned long long allocations = g_allocations.load();
+		unsigned long long first = fired;
+		DriveUntil(manager, fired, first + fires);
+		result.allocations = g_allocations.load() - allocations;
+		result.fires = fired - first;
+
+		for (size_t i = 0; i < timers; i++)
+		{
+			manager.RemoveTimer(tasks[i]);
+			delete tasks[i];
+		}
+		return result;
+	}
+
+	RearmResult BenchTimerWheel(size_t timers, unsigned long long fires)
+	{
+		RearmResult result = { "timer_wheel", 0, 0 };
+		TimerManager manager;
+		std::vector<Timer*> list(timers);
+		unsigned long long fired = 0;
+		for (size_t i = 0; i < timers; i++)
+		{
+			list[i] = new Timer(manager);
+			list[i]->Start([&fired]() { fired++; }, INTERVAL_MS, Timer::CIRCLE);
+		}
+		DriveUntil(manager, fired, timers);
+
+		unsigned long long allocations = g_allocations.load();
+		unsigned long long first = fired;
+		DriveUntil(manager, fired, first + fires);
+		result.allocations = g_allocations.load() - allocations;
+		result.fires = fired - first;
+
+		for (size_t i = 0; i < timers; i++)
+		{
+			delete list[i];
+		}
+		return result;
+	}
+
+	void PrintResult(const RearmResult& result, bool last)
+	{
+		printf("    {\"mode\": \"%s\", \"fires\": %llu, \"allocations\": %llu, \"allocations_per_rearm\": %.4f}%s\n",
+			result.mode, result.fires, result.allocations,
+			result.fires ? (double)result.allocations / result.fires : 0, last ? "" : ",");
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t timers = 100;
+	unsigned long long fires = 100000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc)
+		{
+			timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--fires") == 0 && i + 1 < argc)
+		{
+			fires = strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--timers N] [--fires N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (timers == 0)
+	{
+		timers = 1;
+	}
+
+	RearmResult results[3] = {
+		BenchUtility(utility::TIMER_QUEUE_WHEEL, timers, fires),
+		BenchUtility(utility::TIMER_QUEUE_HEAP, timers, fires),
+		BenchTimerWheel(timers, fires),
+	};
+	bool zero = true;
+	printf("{\n");
+	printf("  \"benchmark\": \"circle_rearm_allocations\",\n");
+	printf("  \"timers\": %zu,\n", timers);
+	printf("  \"interval_ms\": %d,\n", (int)INTERVAL_MS);
+	printf("  \"results\": [\n");
+	for (int i = 0; i < 3; i++)
+	{
+		PrintResult(results[i], i == 2);
+		zero = zero && results[i].allocations == 0;
+	}
+	printf("  ],\n");
+	printf("  \"zero_allocations\": %s\n", zero ? "true" : "false");
+	printf("}\n");
+	return zero ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+/***********************************************
+*ʱ,Ҫ,JSON׼,ڼ鲻ͨʱ1.
+*1.:һʱ--timers30sѭʱ(ģӵĿгʱ),--reschedules,
+*  ÿ1000εһDetectTimers,ƺĶʱʱ·Ŀ,Ŀÿ100:
+*  wheel_lazy/wheel_immediate:timer_wheel.hTimer::Reschedule;
+*  thread_lazy/thread_immediate:TimerThread::RescheduleTimer,ҪͶ.
+*2.ڼ:10msѭʱƺ50ms,֮԰10msڴ.
+*÷: reschedule_benchmark [--timers N] [--reschedules N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "lib_utility.h"
+#include "timer_wheel.h"
+
+namespace {
+
+	enum { IDLE_MS = 30000, TARGET_PER_SECOND = 1000000 };
+
+	struct RescheduleResult
+	{
+		const char* mode;
+		double ns_per_reschedule;
+		double reschedules_per_second;
+	};
+
+	struct PeriodResult
+	{
+		unsigned first_ms;
+		unsigned min_period_ms;
+		unsigned max_period_ms;
+		double avg_period_ms;
+		size_t fires;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	RescheduleResult BenchWheel(size_t timers, size_t reschedules, bool lazy)
+	{
+		RescheduleResult result = { lazy ? "wheel_lazy" : "wheel_immediate", 0, 0 };
+		TimerManager manager;
+		std::vector<Timer*> list(timers);
+		for (size_t i = 0; i < timers; i++)
+		{
+			list[i] = new Timer(manager);
+			list[i]->Start([]() {}, IDLE_MS, Timer::CIRCLE);
+		}
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < reschedules; i++)
+		{
+			list[i % timers]->Reschedule(IDLE_MS, lazy);
+			if (i % 1000 == 999)
+			{
+				manager.DetectTimers();
+			}
+		}
+		unsigned long long elapsed = NowNs() - start;
+		for (size_t i = 0; i < timers; i++)
+		{
+			delete list[i];
+		}
+		result.ns_per_reschedule = (double)elapsed / reschedules;
+		result.reschedules_per_second = elapsed ? reschedules * 1e9 / elapsed : 0;
+		return result;
+	}
+
+	//̵߳ĺʱ,軹Ҫȶʱ̴߳
+	RescheduleResult BenchThread(size_t timers, size_t reschedules, bool lazy)
+	{
+		RescheduleResult result = { lazy ? "thread_lazy" : "thread_immediate", 0, 0 };
+		utility::TimerThread timer_thread(1);
+		timer_thread.StartTimerThread();
+		std::vector<utility::TimerHandle> handles(timers);
+		for (size_t i = 0; i < timers; i++)
+		{
+			handles[i] = timer_thread.SetATimer([]() {}, IDLE_MS, utility::CIRCLE);
+		}
+		while (timer_thread.GetTimerCount() != timers)
+		{
+			std::this_thread::yield();
+		}
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < reschedules; i++)
+		{
+			timer_thread.RescheduleTimer(handles[i % timers], IDLE_MS, lazy);
+		}
+		//һµĶʱȷ֮ǰѴ
+		timer_thread.SetATimer([]() {}, IDLE_MS, utility::ONCE);
+		while (timer_thread.GetTimerCount() != timers + 1)
+		{
+			std::this_thread::yield();
+		}
+		unsigned long long elapsed = NowNs() - start;
+		timer_thread.StopTimers(&handles[0], (int)timers);
+		timer_thread.StopTimerThread();
+		result.ns_per_reschedule = (double)elapsed / reschedules;
+		result.reschedules_per_second = elapsed ? reschedules * 1e9 / elapsed : 0;
+		return result;
+	}
+
+	PeriodResult CheckLazyPeriod()
+	{
+		PeriodResult result = { 0, 0, 0, 0, 0 };
+		TimerManager manager;
+		Timer timer(manager);
+		std::vector<unsigned long long> fires;
+		unsigned long long start = TimerManager::GetCurrentMillisecs();
+		timer.Start([&fires]() { fires.push_back(TimerManager::GetCurrentMillisecs()); }, 10, Timer::CIRCLE);
+		timer.Reschedule(50, true);
+		while (TimerManager::GetCurrentMillisecs() < start + 200)
+		{
+			manager.DetectTimers();
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		timer.Stop();
+		result.fires = fires.size();
+		if (!fires.empty())
+		{
+			result.first_ms = (unsigned)(fires[0] - start);
+			result.min_period_ms = 0xFFFFFFFFu;
+		}
+		for (size_t i = 1; i < fires.size(); i++)
+		{
+			unsigned period = (unsigned)(fires[i] - fires[i - 1]);
+			result.min_period_ms = period < result.min_period_ms ? period : result.min_period_ms;
+			result.max_period_ms = period > result.max_period_ms ? period : result.max_period_ms;
+		}
+		if (fires.size() >= 2)
+		{
+			result.avg_period_ms = (double)(fires.back() - fires[0]) / (fires.size() - 1);
+		}
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t timers = 100000;
+	size_t reschedules = 5000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc)
+		{
+			timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--reschedules") == 0 && i + 1 < argc)
+		{
+			reschedules = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--timers N] [--reschedules N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (timers == 0)
+	{
+		timers = 1;
+	}
+	if (reschedules == 0)
+	{
+		reschedules = 1;
+	}
+
+	RescheduleResult results[4] = {
+		BenchWheel(timers, reschedules, true),
+		BenchWheel(timers, reschedules, false),
+		BenchThread(timers, reschedules, true),
+		BenchThread(timers, reschedules, false),
+	};
+	PeriodResult period = CheckLazyPeriod();
+	//һ50msҴ,֮10ms;ڻΪ̵߳ȱ䳤,Լƽֵ
+	bool period_ok = period.fires >= 2 && period.first_ms >= 50 && period.first_ms < 60 &&
+		period.min_period_ms >= 9 && period.avg_period_ms <= 12;
+
+	printf("{\n");
+	printf("  \"benchmark\": \"reschedule\",\n");
+	printf("  \"timers\": %zu,\n", timers);
+	printf("  \"reschedules\": %zu,\n", reschedules);
+	printf("  \"results\": [\n");
+	for (int i = 0; i < 4; i++)
+	{
+		printf("    {\"mode\": \"%s\", \"ns_per_reschedule\": %.1f, \"reschedules_per_second\": %.0f, \"meets_target\": %s}%s\n",
+			results[i].mode, results[i].ns_per_reschedule, results[i].reschedules_per_second,
+			results[i].reschedules_per_second >= TARGET_PER_SECOND ? "true" : "false", i < 3 ? "," : "");
+	}
+	printf("  ],\n");
+	printf("  \"lazy_period\": {\"interval_ms\": 10, \"postponed_to_ms\": 50, \"first_fire_ms\": %u, \"fires\": %zu, "
+		"\"min_period_ms\": %u, \"max_period_ms\": %u, \"avg_period_ms\": %.1f, \"passed\": %s}\n",
+		period.first_ms, period.fires, period.min_period_ms, period.max_period_ms, period.avg_period_ms, period_ok ? "true" : "false");
+	printf("}\n");
+	return period_ok ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+/***********************************************
+*ƬʱĴ,Ҫ,JSON׼.
+*ֱ1248ƬShardedTimerService(1ms̶),key--timers1msѭʱȷֵƬ,
+*ͳ--duration-msڵĻص,õÿ봥(fires/s).ƬCPUʱ.
+*÷: shard_benchmark [--timers N] [--duration-ms N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "lib_utility.h"
+
+namespace {
+
+	struct ShardResult
+	{
+		int shards;
+		size_t timers;
+		double arm_ns_per_timer;
+		double elapsed_ms;
+		unsigned long long fires;
+		double fires_per_second;
+	};
+
+	//ÿռһ,Ƭ֮߳α
+	struct PaddedCounter
+	{
+		std::atomic<unsigned long long> value;
+		char pad[64 - sizeof(std::atomic<unsigned long long>)];
+	};
+
+	enum { COUNTER_COUNT = 64 };
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	unsigned long long SumCounters(PaddedCounter* counters)
+	{
+		unsigned long long sum = 0;
+		for (int i = 0; i < COUNTER_COUNT; i++)
+		{
+			sum += counters[i].value.load(std::memory_order_relaxed);
+		}
+		return sum;
+	}
+
+	ShardResult BenchShards(int shards, size_t timers, unsigned duration_ms)
+	{
+		ShardResult result = { shards, timers, 0, 0, 0, 0 };
+		std::vector<PaddedCounter> counters(COUNTER_COUNT);
+		for (int i = 0; i < COUNTER_COUNT; i++)
+		{
+			counters[i].value.store(0);
+		}
+		utility::ShardedTimerService service;
+		service.StartService(shards, false, 1);
+
+		std::vector<utility::TimerHandle> handles(timers);
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < timers; i++)
+		{
+			PaddedCounter* counter = &counters[i % COUNTER_COUNT];
+			handles[i] = service.SetATimerByKey(i, [counter]() { counter->value.fetch_add(1, std::memory_order_relaxed); },
+				1, utility::CIRCLE);
+		}
+		result.arm_ns_per_timer = timers ? (double)(NowNs() - start) / timers : 0;
+
+		//жʱʼ֮ټ
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		unsigned long long begin_fires = SumCounters(&counters[0]);
+		unsigned long long begin_ns = NowNs();
+		std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+		result.fires = SumCounters(&counters[0]) - begin_fires;
+		result.elapsed_ms = (double)(NowNs() - begin_ns) / 1e6;
+		result.fires_per_second = result.elapsed_ms > 0 ? result.fires / result.elapsed_ms * 1000 : 0;
+
+		service.StopTimers(&handles[0], (int)handles.size());
+		service.StopService();
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t timers = 100000;
+	unsigned duration_ms = 1000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc)
+		{
+			timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc)
+		{
+			duration_ms = (unsigned)strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--timers N] [--duration-ms N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (timers == 0)
+	{
+		timers = 1;
+	}
+
+	const int shard_counts[] = { 1, 2, 4, 8 };
+	const int count = sizeof(shard_counts) / sizeof(shard_counts[0]);
+	printf("{\n");
+	printf("  \"benchmark\": \"shard_fires\",\n");
+	printf("  \"hardware_concurrency\": %u,\n", std::thread::hardware_concurrency());
+	printf("  \"tick_ms\": 1,\n");
+	printf("  \"interval_ms\": 1,\n");
+	printf("  \"results\": [\n");
+	double base = 0;
+	for (int i = 0; i < count; i++)
+	{
+		ShardResult result = BenchShards(shard_counts[i], timers, duration_ms);
+		if (i == 0)
+		{
+			base = result.fires_per_second;
+		}
+		printf("    {\"shards\": %d, \"timers\": %zu, \"arm_ns_per_timer\": %.1f, \"elapsed_ms\": %.1f, \"fires\": %llu, "
+			"\"fires_per_second\": %.0f, \"speedup\": %.2f}%s\n",
+			result.shards, result.timers, result.arm_ns_per_timer, result.elapsed_ms, result.fires,
+			result.fires_per_second, base > 0 ? result.fires_per_second / base : 0, i + 1 < count ? "," : "");
+		fflush(stdout);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
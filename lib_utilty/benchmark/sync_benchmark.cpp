@@ -0,0 +1,398 @@
+/***********************************************
+*ͬԭܲ,Ҫ,JSON׼.
+*1./:CommonMutexstd::mutex,1߳(޾)--threads߳(о)--iterations,õÿεĺʱ;
+*2.֪ͨ/ȴӳ:߳һCommonSemaphoreһCommonEventһstd::condition_variable֪ͨ--round-trips,
+*  ӳȡһһ,p50/p99.
+*3.Ӧ:MUTEX_ADAPTIVEMUTEX_DEFAULT(pthread뻥)164߳µ,
+*  ÿ鹲--adaptive-opsμ,ƽָ߳.
+*4.д:141664̶߳һС,1%ĲΪд,--rwlock-ops,
+*  ȽCommonRWLock(ȡд)ֻCommonMutexʱ.
+*÷: sync_benchmark [--threads N] [--iterations N] [--round-trips N] [--adaptive-ops N] [--rwlock-ops N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "lib_utility.h"
+
+namespace {
+
+	struct StdMutexLock
+	{
+		std::mutex mutex;
+		void Lock() { mutex.lock(); }
+		void Unlock() { mutex.unlock(); }
+	};
+
+	struct CommonMutexLock
+	{
+		explicit CommonMutexLock(utility::MutexMode mode = utility::MUTEX_DEFAULT) : mutex("", mode) {}
+		utility::CommonMutex mutex;
+		void Lock() { mutex.LockObject(); }
+		void Unlock() { mutex.UnlockObject(); }
+	};
+
+	struct LockResult
+	{
+		double ns_per_op;
+		double ops_per_second;
+		bool counter_ok;
+	};
+
+	struct LatencyResult
+	{
+		double p50_ns;
+		double p99_ns;
+		double max_ns;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	//ÿ̼߳޸Ĺiterations;ʱ̵߳ܲƽ
+	template <class Lock>
+	LockResult BenchLock(Lock& lock, int threads, size_t iterations)
+	{
+		LockResult result = { 0, 0, false };
+		unsigned long long counter = 0;
+		std::vector<std::thread> workers;
+		unsigned long long start = NowNs();
+		for (int t = 0; t < threads; t++)
+		{
+			workers.push_back(std::thread([&lock, &counter, iterations]() {
+				for (size_t i = 0; i < iterations; i++)
+				{
+					lock.Lock();
+					counter++;
+					lock.Unlock();
+				}
+			}));
+		}
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+		unsigned long long elapsed = NowNs() - start;
+		size_t total = (size_t)threads * iterations;
+		result.ns_per_op = total ? (double)elapsed / total : 0;
+		result.ops_per_second = elapsed ? total * 1e9 / elapsed : 0;
+		result.counter_ok = counter == total;
+		return result;
+	}
+
+	LatencyResult MakeLatency(std::vector<unsigned long long>& round_trips)
+	{
+		LatencyResult result = { 0, 0, 0 };
+		if (round_trips.empty())
+		{
+			return result;
+		}
+		std::sort(round_trips.begin(), round_trips.end());
+		result.p50_ns = round_trips[(round_trips.size() - 1) / 2] / 2.0;
+		result.p99_ns = round_trips[(size_t)((round_trips.size() - 1) * 0.99)] / 2.0;
+		result.max_ns = round_trips.back() / 2.0;
+		return result;
+	}
+
+	LatencyResult BenchSemaphorePingPong(size_t round_trips)
+	{
+		utility::CommonSemaphore ping(0, 1);
+		utility::CommonSemaphore pong(0, 1);
+		std::thread worker([&ping, &pong, round_trips]() {
+			for (size_t i = 0; i < round_trips; i++)
+			{
+				ping.WaitForSemSignaled();
+				pong.ReleaseSemObject();
+			}
+		});
+		std::vector<unsigned long long> samples(round_trips);
+		for (size_t i = 0; i < round_trips; i++)
+		{
+			unsigned long long start = NowNs();
+			ping.ReleaseSemObject();
+			pong.WaitForSemSignaled();
+			samples[i] = NowNs() - start;
+		}
+		worker.join();
+		return MakeLatency(samples);
+	}
+
+	//ֶλ¼:ȵ֮ɵȴλ,֪ͨԷ
+	LatencyResult BenchEventPingPong(size_t round_trips)
+	{
+		utility::CommonEvent ping;
+		utility::CommonEvent pong;
+		std::thread worker([&ping, &pong, round_trips]() {
+			for (size_t i = 0; i < round_trips; i++)
+			{
+				ping.WaitForEventSignaled();
+				ping.ResetEvent();
+				pong.SetEvent();
+			}
+		});
+		std::vector<unsigned long long> samples(round_trips);
+		for (size_t i = 0; i < round_trips; i++)
+		{
+			unsigned long long start = NowNs();
+			ping.SetEvent();
+			pong.WaitForEventSignaled();
+			pong.ResetEvent();
+			samples[i] = NowNs() - start;
+		}
+		worker.join();
+		return MakeLatency(samples);
+	}
+
+	//std::mutex+std::condition_variableʵֵļź,Ϊ
+	struct StdSemaphore
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		int count;
+
+		StdSemaphore() : count(0) {}
+		void Wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cond.wait(lock, [this]() { return count > 0; });
+			count--;
+		}
+		void Post()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				count++;
+			}
+			cond.notify_one();
+		}
+	};
+
+	LatencyResult BenchStdPingPong(size_t round_trips)
+	{
+		StdSemaphore ping;
+		StdSemaphore pong;
+		std::thread worker([&ping, &pong, round_trips]() {
+			for (size_t i = 0; i < round_trips; i++)
+			{
+				ping.Wait();
+				pong.Post();
+			}
+		});
+		std::vector<unsigned long long> samples(round_trips);
+		for (size_t i = 0; i < round_trips; i++)
+		{
+			unsigned long long start = NowNs();
+			ping.Post();
+			pong.Wait();
+			samples[i] = NowNs() - start;
+		}
+		worker.join();
+		return MakeLatency(samples);
+	}
+
+	struct RWLockShared
+	{
+		explicit RWLockShared(bool prefer_writer) : lock(prefer_writer) {}
+		utility::CommonRWLock lock;
+		void LockShared() { lock.LockShared(); }
+		void UnlockShared() { lock.UnlockShared(); }
+		void Lock() { lock.LockExclusive(); }
+		void Unlock() { lock.UnlockExclusive(); }
+	};
+
+	//Ҳӻ,Ϊ
+	struct MutexShared
+	{
+		CommonMutexLock mutex;
+		void LockShared() { mutex.Lock(); }
+		void UnlockShared() { mutex.Unlock(); }
+		void Lock() { mutex.Lock(); }
+		void Unlock() { mutex.Unlock(); }
+	};
+
+	enum { SHARED_VALUES = 16 };
+
+	//ÿ100β1д(Ԫؼ1),();ʱÿԪضӦдܴ
+	template <class Lock>
+	LockResult BenchReadMostly(Lock& lock, int threads, size_t ops_per_thread)
+	{
+		LockResult result = { 0, 0, false };
+		unsigned long long values[SHARED_VALUES] = { 0 };
+		std::vector<std::thread> workers;
+		unsigned long long start = NowNs();
+		for (int t = 0; t < threads; t++)
+		{
+			workers.push_back(std::thread([&lock, &values, ops_per_thread, t]() {
+				volatile unsigned long long sink = 0;
+				for (size_t i = 0; i < ops_per_thread; i++)
+				{
+					if ((i + t) % 100 == 0)
+					{
+						lock.Lock();
+						for (int k = 0; k < SHARED_VALUES; k++)
+						{
+							values[k]++;
+						}
+						lock.Unlock();
+					}
+					else
+					{
+						lock.LockShared();
+						unsigned long long sum = 0;
+						for (int k = 0; k < SHARED_VALUES; k++)
+						{
+							sum += values[k];
+						}
+						lock.UnlockShared();
+						sink = sum;
+					}
+				}
+				(void)sink;
+			}));
+		}
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+		unsigned long long elapsed = NowNs() - start;
+		size_t writes = 0;
+		for (int t = 0; t < threads; t++)
+		{
+			for (size_t i = 0; i < ops_per_thread; i++)
+			{
+				writes += (i + t) % 100 == 0 ? 1 : 0;
+			}
+		}
+		size_t total = (size_t)threads * ops_per_thread;
+		result.ns_per_op = total ? (double)elapsed / total : 0;
+		result.ops_per_second = elapsed ? total * 1e9 / elapsed : 0;
+		result.counter_ok = true;
+		for (int k = 0; k < SHARED_VALUES; k++)
+		{
+			result.counter_ok = result.counter_ok && values[k] == writes;
+		}
+		return result;
+	}
+
+	void PrintLock(const char* primitive, int threads, const LockResult& result, bool last)
+	{
+		printf("    {\"primitive\": \"%s\", \"threads\": %d, \"ns_per_op\": %.1f, \"ops_per_second\": %.0f, \"counter_ok\": %s}%s\n",
+			primitive, threads, result.ns_per_op, result.ops_per_second, result.counter_ok ? "true" : "false", last ? "" : ",");
+	}
+
+	void PrintLatency(const char* primitive, const LatencyResult& result, bool last)
+	{
+		printf("    {\"primitive\": \"%s\", \"p50_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f}%s\n",
+			primitive, result.p50_ns, result.p99_ns, result.max_ns, last ? "" : ",");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int threads = 4;
+	size_t iterations = 1000000;
+	size_t round_trips = 20000;
+	size_t adaptive_ops = 2000000;
+	size_t rwlock_ops = 2000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			iterations = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--round-trips") == 0 && i + 1 < argc)
+		{
+			round_trips = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--adaptive-ops") == 0 && i + 1 < argc)
+		{
+			adaptive_ops = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--rwlock-ops") == 0 && i + 1 < argc)
+		{
+			rwlock_ops = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--threads N] [--iterations N] [--round-trips N] [--adaptive-ops N] [--rwlock-ops N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (threads <= 1)
+	{
+		threads = 2;
+	}
+
+	printf("{\n");
+	printf("  \"benchmark\": \"sync_primitives\",\n");
+	printf("  \"hardware_concurrency\": %u,\n", std::thread::hardware_concurrency());
+	printf("  \"iterations_per_thread\": %zu,\n", iterations);
+	printf("  \"lock_unlock\": [\n");
+	{
+		CommonMutexLock common;
+		StdMutexLock std_mutex;
+		PrintLock("CommonMutex", 1, BenchLock(common, 1, iterations), false);
+		PrintLock("std::mutex", 1, BenchLock(std_mutex, 1, iterations), false);
+		PrintLock("CommonMutex", threads, BenchLock(common, threads, iterations), false);
+		PrintLock("std::mutex", threads, BenchLock(std_mutex, threads, iterations), true);
+	}
+	printf("  ],\n");
+	printf("  \"round_trips\": %zu,\n", round_trips);
+	printf("  \"signal_wait_latency\": [\n");
+	PrintLatency("CommonSemaphore", BenchSemaphorePingPong(round_trips), false);
+	PrintLatency("CommonEvent", BenchEventPingPong(round_trips), false);
+	PrintLatency("std::condition_variable", BenchStdPingPong(round_trips), true);
+	printf("  ],\n");
+	printf("  \"adaptive_ops\": %zu,\n", adaptive_ops);
+	printf("  \"adaptive_mutex\": [\n");
+	const int thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	const int count = sizeof(thread_counts) / sizeof(thread_counts[0]);
+	for (int i = 0; i < count; i++)
+	{
+		size_t per_thread = adaptive_ops / thread_counts[i];
+		CommonMutexLock adaptive(utility::MUTEX_ADAPTIVE);
+		CommonMutexLock current(utility::MUTEX_DEFAULT);
+		LockResult adaptive_result = BenchLock(adaptive, thread_counts[i], per_thread);
+		LockResult current_result = BenchLock(current, thread_counts[i], per_thread);
+		printf("    {\"threads\": %d, \"adaptive_ops_per_second\": %.0f, \"default_ops_per_second\": %.0f, \"speedup\": %.2f, \"counter_ok\": %s}%s\n",
+			thread_counts[i], adaptive_result.ops_per_second, current_result.ops_per_second,
+			current_result.ops_per_second > 0 ? adaptive_result.ops_per_second / current_result.ops_per_second : 0,
+			adaptive_result.counter_ok && current_result.counter_ok ? "true" : "false", i + 1 < count ? "," : "");
+		fflush(stdout);
+	}
+	printf("  ],\n");
+	printf("  \"rwlock_ops\": %zu,\n", rwlock_ops);
+	printf("  \"rwlock_write_percent\": 1,\n");
+	printf("  \"rwlock\": [\n");
+	const int reader_counts[] = { 1, 4, 16, 64 };
+	const int reader_count = sizeof(reader_counts) / sizeof(reader_counts[0]);
+	for (int i = 0; i < reader_count; i++)
+	{
+		size_t per_thread = rwlock_ops / reader_counts[i];
+		RWLockShared prefer_reader(false);
+		RWLockShared prefer_writer(true);
+		MutexShared mutex;
+		LockResult reader_result = BenchReadMostly(prefer_reader, reader_counts[i], per_thread);
+		LockResult writer_result = BenchReadMostly(prefer_writer, reader_counts[i], per_thread);
+		LockResult mutex_result = BenchReadMostly(mutex, reader_counts[i], per_thread);
+		printf("    {\"threads\": %d, \"rwlock_ops_per_second\": %.0f, \"rwlock_prefer_writer_ops_per_second\": %.0f, "
+			"\"mutex_ops_per_second\": %.0f, \"values_ok\": %s}%s\n",
+			reader_counts[i], reader_result.ops_per_second, writer_result.ops_per_second, mutex_result.ops_per_second,
+			reader_result.counter_ok && writer_result.counter_ok && mutex_result.counter_ok ? "true" : "false",
+			i + 1 < reader_count ? "," : "");
+		fflush(stdout);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,279 @@
+/***********************************************
+*̳߳ܲ,Ҫ,JSON׼.
+*ȽϹȡThreadPoolֻһе̳߳():
+*1.fib:fib(--fib-n),--fib-cutoffʱм,ύfib(n-1)Լfib(n-2);
+*2.п:--sort-size,--sort-cutoffʱstd::sort,ύ벿֡ԼҰ벿.
+*̳߳ڵȴʱִже,ֱ߳Ϊ1248.
+*÷: thread_pool_benchmark [--fib-n N] [--fib-cutoff N] [--sort-size N] [--sort-cutoff N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "lib_utility.h"
+
+namespace {
+
+	//:̹߳һstd::mutexĶ
+	class LockedQueuePool
+	{
+	public:
+		LockedQueuePool() : exit_flag_(false) {}
+		~LockedQueuePool() { StopPool(); }
+
+		void StartPool(int thread_count)
+		{
+			exit_flag_ = false;
+			for (int i = 0; i < thread_count; i++)
+			{
+				threads_.push_back(std::thread([this]() { WorkLoop(); }));
+			}
+		}
+
+		void StopPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				exit_flag_ = true;
+			}
+			cond_.notify_all();
+			for (size_t i = 0; i < threads_.size(); i++)
+			{
+				threads_[i].join();
+			}
+			threads_.clear();
+			while (!tasks_.empty())
+			{
+				tasks_.front()->Discard();
+				tasks_.pop_front();
+			}
+		}
+
+		template <class F>
+		std::future<decltype(std::declval<typename std::decay<F>::type&>()())> Submit(F&& func)
+		{
+			typedef decltype(std::declval<typename std::decay<F>::type&>()()) R;
+			utility::PackagedPoolTask<R>* task = new utility::PackagedPoolTask<R>(std::forward<F>(func));
+			std::future<R> result = task->promise_.get_future();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				tasks_.push_back(task);
+			}
+			cond_.notify_one();
+			return result;
+		}
+
+		/*ȴڼӶβȡµִ,ݹ񲻻ռס߳;
+		*ͷȡִ,Ƕ׵ĵȴû,ջ*/
+		template <class R>
+		R WaitFor(std::future<R>& result)
+		{
+			while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				utility::PoolTask* task = TryPopNewest();
+				if (task != NULL)
+				{
+					task->Execute();
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+			return result.get();
+		}
+
+	private:
+		utility::PoolTask* TryPopNewest()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (tasks_.empty())
+			{
+				return NULL;
+			}
+			utility::PoolTask* task = tasks_.back();
+			tasks_.pop_back();
+			return task;
+		}
+
+		void WorkLoop()
+		{
+			for (;;)
+			{
+				utility::PoolTask* task = NULL;
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					cond_.wait(lock, [this]() { return exit_flag_ || !tasks_.empty(); });
+					if (exit_flag_)
+					{
+						return;
+					}
+					task = tasks_.front();
+					tasks_.pop_front();
+				}
+				task->Execute();
+			}
+		}
+
+		std::mutex mutex_;
+		std::condition_variable cond_;
+		std::deque<utility::PoolTask*> tasks_;
+		std::vector<std::thread> threads_;
+		bool exit_flag_;
+	};
+
+	struct PoolResult
+	{
+		double fib_ms;
+		unsigned long long fib_value;
+		double sort_ms;
+		bool sorted;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	unsigned long long SerialFib(int n)
+	{
+		return n < 2 ? (unsigned long long)n : SerialFib(n - 1) + SerialFib(n - 2);
+	}
+
+	template <class Pool>
+	unsigned long long ParallelFib(Pool& pool, int n, int cutoff)
+	{
+		if (n <= cutoff)
+		{
+			return SerialFib(n);
+		}
+		std::future<unsigned long long> left = pool.Submit([&pool, n, cutoff]() { return ParallelFib(pool, n - 1, cutoff); });
+		unsigned long long right = ParallelFib(pool, n - 2, cutoff);
+		return pool.WaitFor(left) + right;
+	}
+
+	template <class Pool>
+	void ParallelSort(Pool& pool, int* begin, int* end, size_t cutoff)
+	{
+		if ((size_t)(end - begin) <= cutoff)
+		{
+			std::sort(begin, end);
+			return;
+		}
+		int pivot = begin[(end - begin) / 2];
+		int* middle1 = std::partition(begin, end, [pivot](int value) { return value < pivot; });
+		int* middle2 = std::partition(middle1, end, [pivot](int value) { return !(pivot < value); });
+		std::future<void> left = pool.Submit([&pool, begin, middle1, cutoff]() { ParallelSort(pool, begin, middle1, cutoff); });
+		ParallelSort(pool, middle2, end, cutoff);
+		pool.WaitFor(left);
+	}
+
+	template <class Pool>
+	PoolResult RunPool(Pool& pool, int fib_n, int fib_cutoff, const std::vector<int>& input, size_t sort_cutoff)
+	{
+		PoolResult result = { 0, 0, 0, false };
+		unsigned long long start = NowNs();
+		std::future<unsigned long long> fib = pool.Submit([&pool, fib_n, fib_cutoff]() { return ParallelFib(pool, fib_n, fib_cutoff); });
+		result.fib_value = pool.WaitFor(fib);
+		result.fib_ms = (double)(NowNs() - start) / 1e6;
+
+		std::vector<int> data(input);
+		int* begin = data.empty() ? NULL : &data[0];
+		int* end = begin + data.size();
+		start = NowNs();
+		std::future<void> sort = pool.Submit([&pool, begin, end, sort_cutoff]() { ParallelSort(pool, begin, end, sort_cutoff); });
+		pool.WaitFor(sort);
+		result.sort_ms = (double)(NowNs() - start) / 1e6;
+		result.sorted = std::is_sorted(data.begin(), data.end());
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int fib_n = 32;
+	int fib_cutoff = 12;
+	size_t sort_size = 4000000;
+	size_t sort_cutoff = 4096;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--fib-n") == 0 && i + 1 < argc)
+		{
+			fib_n = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--fib-cutoff") == 0 && i + 1 < argc)
+		{
+			fib_cutoff = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--sort-size") == 0 && i + 1 < argc)
+		{
+			sort_size = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--sort-cutoff") == 0 && i + 1 < argc)
+		{
+			sort_cutoff = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--fib-n N] [--fib-cutoff N] [--sort-size N] [--sort-cutoff N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (sort_cutoff == 0)
+	{
+		sort_cutoff = 1;
+	}
+
+	std::vector<int> input(sort_size);
+	unsigned seed = 12345;
+	for (size_t i = 0; i < sort_size; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		input[i] = (int)(seed >> 1);
+	}
+	unsigned long long expected_fib = SerialFib(fib_n);
+
+	const int thread_counts[] = { 1, 2, 4, 8 };
+	const int count = sizeof(thread_counts) / sizeof(thread_counts[0]);
+	printf("{\n");
+	printf("  \"benchmark\": \"thread_pool\",\n");
+	printf("  \"hardware_concurrency\": %u,\n", std::thread::hardware_concurrency());
+	printf("  \"fib_n\": %d,\n", fib_n);
+	printf("  \"fib_cutoff\": %d,\n", fib_cutoff);
+	printf("  \"sort_size\": %zu,\n", sort_size);
+	printf("  \"sort_cutoff\": %zu,\n", sort_cutoff);
+	printf("  \"results\": [\n");
+	for (int i = 0; i < count; i++)
+	{
+		PoolResult stealing_result;
+		PoolResult locked_result;
+		{
+			utility::ThreadPool pool;
+			pool.StartPool(thread_counts[i]);
+			stealing_result = RunPool(pool, fib_n, fib_cutoff, input, sort_cutoff);
+			pool.StopPool();
+		}
+		{
+			LockedQueuePool pool;
+			pool.StartPool(thread_counts[i]);
+			locked_result = RunPool(pool, fib_n, fib_cutoff, input, sort_cutoff);
+			pool.StopPool();
+		}
+		bool correct = stealing_result.fib_value == expected_fib && locked_result.fib_value == expected_fib &&
+			stealing_result.sorted && locked_result.sorted;
+		printf("    {\"threads\": %d, \"work_stealing_fib_ms\": %.1f, \"locked_queue_fib_ms\": %.1f, "
+			"\"work_stealing_sort_ms\": %.1f, \"locked_queue_sort_ms\": %.1f, \"correct\": %s}%s\n",
+			thread_counts[i], stealing_result.fib_ms, locked_result.fib_ms, stealing_result.sort_ms, locked_result.sort_ms,
+			correct ? "true" : "false", i + 1 < count ? "," : "");
+		fflush(stdout);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
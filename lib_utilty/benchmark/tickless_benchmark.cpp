@@ -0,0 +1,130 @@
+/***********************************************
+*ʱ̻߳Ѵ,Ҫ,JSON׼.
+*ָطֱڰ̶ȻѺ޿̶(tickless)ģʽ--duration-ms,ͳƶʱ̱߳ѵĴ,ÿӵĻѴ:
+*idle:ֻһ1Сʱ֮ڵĶʱ;
+*sparse:16500ms2000ms֮ѭʱ;
+*dense:100001ms100ms֮ѭʱ.
+*÷: tickless_benchmark [--tick-ms N] [--duration-ms N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "lib_utility.h"
+
+namespace {
+
+	struct Workload
+	{
+		const char* name;
+		size_t timers;
+		unsigned min_interval_ms;
+		unsigned max_interval_ms;
+	};
+
+	struct WakeupResult
+	{
+		const char* workload;
+		bool tickless;
+		unsigned long long wakeups;
+		unsigned long long fires;
+		double elapsed_ms;
+		double wakeups_per_minute;
+		double fires_per_minute;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	WakeupResult BenchWakeups(const Workload& workload, bool tickless, unsigned tick_ms, unsigned duration_ms)
+	{
+		WakeupResult result = { workload.name, tickless, 0, 0, 0, 0, 0 };
+		std::atomic<unsigned long long> fires(0);
+		utility::TimerThread timer_thread(tick_ms);
+		timer_thread.SetTicklessMode(tickless);
+		timer_thread.StartTimerThread();
+
+		std::vector<utility::TimerHandle> handles(workload.timers);
+		unsigned span = workload.max_interval_ms - workload.min_interval_ms + 1;
+		for (size_t i = 0; i < workload.timers; i++)
+		{
+			handles[i] = timer_thread.SetATimer([&fires]() { fires.fetch_add(1, std::memory_order_relaxed); },
+				workload.min_interval_ms + (unsigned)(i * 7919 % span), utility::CIRCLE);
+		}
+
+		//öʱʱͶĻѲ
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		unsigned long long begin_wakeups = timer_thread.GetWakeupCount();
+		unsigned long long begin_fires = fires.load();
+		unsigned long long begin_ns = NowNs();
+		std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+		result.wakeups = timer_thread.GetWakeupCount() - begin_wakeups;
+		result.fires = fires.load() - begin_fires;
+		result.elapsed_ms = (double)(NowNs() - begin_ns) / 1e6;
+		result.wakeups_per_minute = result.elapsed_ms > 0 ? result.wakeups / result.elapsed_ms * 60000 : 0;
+		result.fires_per_minute = result.elapsed_ms > 0 ? result.fires / result.elapsed_ms * 60000 : 0;
+
+		timer_thread.StopTimers(&handles[0], (int)handles.size());
+		timer_thread.StopTimerThread();
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned tick_ms = 1;
+	unsigned duration_ms = 5000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc)
+		{
+			tick_ms = (unsigned)strtoul(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc)
+		{
+			duration_ms = (unsigned)strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--tick-ms N] [--duration-ms N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (tick_ms == 0)
+	{
+		tick_ms = 1;
+	}
+
+	const Workload workloads[] = {
+		{ "idle", 1, 3600000, 3600000 },
+		{ "sparse", 16, 500, 2000 },
+		{ "dense", 10000, 1, 100 },
+	};
+	const int count = sizeof(workloads) / sizeof(workloads[0]);
+	printf("{\n");
+	printf("  \"benchmark\": \"tickless_wakeups\",\n");
+	printf("  \"tick_ms\": %u,\n", tick_ms);
+	printf("  \"duration_ms\": %u,\n", duration_ms);
+	printf("  \"results\": [\n");
+	for (int i = 0; i < count; i++)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			WakeupResult result = BenchWakeups(workloads[i], mode == 1, tick_ms, duration_ms);
+			printf("    {\"workload\": \"%s\", \"timers\": %zu, \"mode\": \"%s\", \"wakeups\": %llu, \"fires\": %llu, "
+				"\"elapsed_ms\": %.1f, \"wakeups_per_minute\": %.0f, \"fires_per_minute\": %.0f}%s\n",
+				result.workload, workloads[i].timers, result.tickless ? "tickless" : "ticked", result.wakeups, result.fires,
+				result.elapsed_ms, result.wakeups_per_minute, result.fires_per_minute,
+				i + 1 < count || mode == 0 ? "," : "");
+			fflush(stdout);
+		}
+	}
+	printf("  ]\n");
+	printf("}\n");
+	return 0;
+}
\ No newline at end of file
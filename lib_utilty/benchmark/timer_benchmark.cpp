@@ -0,0 +1,600 @@
+/***********************************************
+*ʱ׼,Ҫ,JSON׼.
+*ֱutility::TimerManager(ԼTimerThread)timer_wheel.hеTimerManager:
+*ӡֹͣ衢ڴ,ڻصԵʱӳٷֲ,Լÿʱռõڴ.
+*1%Ļص50msʱ,صڶʱִ߳кͽִ߳еӳٷֲ,Լַʱӳٷֲ;
+*Լͬʱ¶Ѻʱ/ֹͣ/ڻϲµĺʱ(ȵĺĸһ),Ѳʱʱ.
+*ӳٲڼõĶʱͳ(TimerStats),ʱNO_TIMER_STATSʱȫΪ0.
+*жʱǰ(ӳΪ)ʱ1.
+*÷: timer_benchmark [--max-timers N] [--latency-max-timers N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <random>
+#include "lib_utility.h"
+#include "timer_wheel.h"
+#include "timer_stats.h"
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+namespace {
+
+	typedef ::TimerManager WheelTimerManager;
+
+	struct Throughput
+	{
+		const char* manager;
+		size_t timers;
+		double arm_ns;
+		double reschedule_ns;
+		double cancel_ns;
+		double fire_ns;
+		double bytes_per_timer;
+	};
+
+	struct QueueMix
+	{
+		const char* queue;
+		size_t timers;
+		double arm_cancel_ns;//ֹͣһʱ
+		double fire_ns;
+		double mix_ns;//ÿβƽʱ,10%ĶʱӺܿ쵽
+	};
+
+	struct Latency
+	{
+		const char* manager;
+		size_t timers;
+		double min_us;
+		double p50_us;
+		double p99_us;
+		double p999_us;
+		double max_us;
+	};
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	double NsPerOp(unsigned long long start, unsigned long long end, size_t count)
+	{
+		return count > 0 ? (double)(end - start) / (double)count : 0;
+	}
+
+	//̵ĳפڴ,ֵ֧ƽ̨0
+	long long GetResidentBytes()
+	{
+#ifdef _WIN32
+		return 0;
+#else
+		FILE* file = fopen("/proc/self/statm", "r");
+		if (file == NULL)
+		{
+			return 0;
+		}
+		long long size = 0, resident = 0;
+		if (fscanf(file, "%lld %lld", &size, &resident) != 2)
+		{
+			resident = 0;
+		}
+		fclose(file);
+		return resident * sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+	void SleepMs(unsigned ms)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+	}
+
+	//ֲ[min_ms, min_ms + range_ms)
+	std::vector<unsigned> MakeIntervals(size_t count, unsigned min_ms, unsigned range_ms, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::vector<unsigned> intervals(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			intervals[i] = min_ms + rng() % range_ms;
+		}
+		return intervals;
+	}
+
+	Throughput BenchUtilityManager(size_t count)
+	{
+		Throughput result = { "utility::TimerManager", count, 0, 0, 0, 0, 0 };
+		utility::TimerManager manager(1);
+		std::vector<unsigned> intervals = MakeIntervals(count, 60000, 3600000, 1);
+		std::vector<utility::TimerTask*> tasks(count);
+		unsigned long long fired = 0;
+
+		long long rss_before = GetResidentBytes();
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			utility::TimerTask* task = new utility::TimerTask();
+			task->SetTimerCallback([&fired]() { fired++; });
+			task->SetTimerTask(NULL, intervals[i], utility::ONCE);
+			manager.AddTimer(task);
+			tasks[i] = task;
+		}
+		unsigned long long end = NowNs();
+		result.arm_ns = NsPerOp(start, end, count);
+		result.bytes_per_timer = (double)(GetResidentBytes() - rss_before) / count;
+
+		start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			manager.RescheduleTimer(tasks[i], intervals[count - 1 - i]);
+		}
+		end = NowNs();
+		result.reschedule_ns = NsPerOp(start, end, count);
+
+		start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			manager.RemoveTimer(tasks[i]);
+		}
+		end = NowNs();
+		result.cancel_ns = NsPerOp(start, end, count);
+
+		//ȫڼڵ,ȵ֮һDetectTimersȫ
+		for (size_t i = 0; i < count; i++)
+		{
+			manager.RescheduleTimer(tasks[i], 1 + (unsigned)(i % 16));
+		}
+		SleepMs(20);
+		start = NowNs();
+		manager.DetectTimers();
+		end = NowNs();
+		result.fire_ns = NsPerOp(start, end, (size_t)fired);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			manager.RemoveTimer(tasks[i]);
+			delete tasks[i];
+		}
+		return result;
+	}
+
+	Throughput BenchWheelManager(size_t count)
+	{
+		Throughput result = { "timer_wheel::TimerManager", count, 0, 0, 0, 0, 0 };
+		WheelTimerManager manager;
+		std::vector<unsigned> intervals = MakeIntervals(count, 60000, 3600000, 1);
+		std::vector<Timer*> timers(count);
+		unsigned long long fired = 0;
+
+		long long rss_before = GetResidentBytes();
+		unsigned long long start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			timers[i] = new Timer(manager);
+			timers[i]->Start([&fired]() { fired++; }, intervals[i], Timer::ONCE);
+		}
+		unsigned long long end = NowNs();
+		result.arm_ns = NsPerOp(start, end, count);
+		result.bytes_per_timer = (double)(GetResidentBytes() - rss_before) / count;
+
+		start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			timers[i]->Reschedule(intervals[count - 1 - i]);
+		}
+		end = NowNs();
+		result.reschedule_ns = NsPerOp(start, end, count);
+
+		start = NowNs();
+		for (size_t i = 0; i < count; i++)
+		{
+			timers[i]->Stop();
+		}
+		end = NowNs();
+		result.cancel_ns = NsPerOp(start, end, count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			timers[i]->Start([&fired]() { fired++; }, 1 + (unsigned)(i % 16), Timer::ONCE);
+		}
+		SleepMs(20);
+		start = NowNs();
+		manager.DetectTimers();
+		end = NowNs();
+		result.fire_ns = NsPerOp(start, end, (size_t)fired);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			delete timers[i];
+		}
+		return result;
+	}
+
+	//L2󼸱,һΰ֮ǰõĶкͶʱL1/L2
+	void EvictCaches()
+	{
+		static std::vector<unsigned char> buffer(8 << 20);
+		for (size_t i = 0; i < buffer.size(); i += 64)
+		{
+			buffer[i]++;
+		}
+	}
+
+	/*timersʱһֱ(1~61),ÿβֹͣһ:
+	*90%ȻӽԶļ,10%1ms,ÿ256β֮ʱ߹1msٵDetectTimers.
+	*ֻͳƲDetectTimersĺʱ,ȴʱӵʱ䲻.
+	*coldΪtrueʱÿ8βÿDetectTimers֮ǰȱ8MBڴ,ģⶨʱ֮߳˱,
+	*ʱҲ*/
+	QueueMix BenchQueueMix(size_t timers, utility::TimerQueuePolicy policy, bool cold)
+	{
+		const size_t OPS = cold ? 2048 : 20000, CHUNK = cold ? 8 : 256;
+		QueueMix result = { policy == utility::TIMER_QUEUE_HEAP ? "heap" : "wheel", timers, 0, 0, 0 };
+		utility::TimerManager manager(1);
+		manager.SetQueuePolicy(policy);
+		std::vector<unsigned> intervals = MakeIntervals(timers, 60000, 3600000, 3);
+		std::vector<utility::TimerTask*> tasks(timers);
+		unsigned long long fired = 0;
+		for (size_t i = 0; i < timers; i++)
+		{
+			tasks[i] = new utility::TimerTask();
+			tasks[i]->SetTimerCallback([&fired]() { fired++; });
+			tasks[i]->SetTimerTask(NULL, intervals[i], utility::ONCE);
+			manager.AddTimer(tasks[i]);
+		}
+
+		std::mt19937 rng(4);
+		unsigned long long arm_cancel_total = 0, fire_total = 0;
+		for (size_t done = 0; done < OPS; done += CHUNK)
+		{
+			if (cold)
+			{
+				EvictCaches();
+			}
+			unsigned long long start = NowNs();
+			for (size_t i = 0; i < CHUNK; i++)
+			{
+				utility::TimerTask* task = tasks[rng() % timers];
+				manager.RemoveTimer(task);
+				task->SetIntervalTime(rng() % 10 == 0 ? 1 : intervals[i % timers]);
+				manager.AddTimer(task);
+			}
+			unsigned long long end = NowNs();
+			arm_cancel_total += end - start;
+
+			while (NowNs() - end < 2000000ULL)
+			{
+				std::this_thread::yield();
+			}
+			if (cold)
+			{
+				EvictCaches();
+			}
+			start = NowNs();
+			manager.DetectTimers();
+			fire_total += NowNs() - start;
+
+			//ڵONCEʱ,ִ
+			for (size_t i = 0; i < timers; i++)
+			{
+				if (!manager.IsHeapQueue() ? !utility::TimerTaskWheel::IsLinked(tasks[i]) : !utility::TimerHeap::IsLinked(tasks[i]))
+				{
+					tasks[i]->SetIntervalTime(intervals[i]);
+					manager.AddTimer(tasks[i]);
+				}
+			}
+		}
+		result.arm_cancel_ns = (double)arm_cancel_total / OPS;
+		result.fire_ns = fired > 0 ? (double)fire_total / fired : 0;
+		result.mix_ns = (double)(arm_cancel_total + fire_total) / OPS;
+
+		for (size_t i = 0; i < timers; i++)
+		{
+			manager.RemoveTimer(tasks[i]);
+			delete tasks[i];
+		}
+		return result;
+	}
+
+	void KeepFaster(QueueMix& best, const QueueMix& mix)
+	{
+		best.arm_cancel_ns = std::min(best.arm_cancel_ns, mix.arm_cancel_ns);
+		best.fire_ns = std::min(best.fire_ns, mix.fire_ns);
+		best.mix_ns = std::min(best.mix_ns, mix.mix_ns);
+	}
+
+	/*ÿβӽ,غͶ֮ǰµĿڴ治Ӱڴͳ.
+	*Windowsֱڱ*/
+	Throughput RunIsolated(Throughput (*bench)(size_t), size_t count)
+	{
+#ifdef _WIN32
+		return bench(count);
+#else
+		int fds[2];
+		if (pipe(fds) != 0)
+		{
+			return bench(count);
+		}
+		fflush(stdout);
+		pid_t pid = fork();
+		if (pid < 0)
+		{
+			close(fds[0]);
+			close(fds[1]);
+			return bench(count);
+		}
+		if (pid == 0)
+		{
+			close(fds[0]);
+			Throughput result = bench(count);
+			ssize_t written = write(fds[1], &result, sizeof(result));
+			_exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+		}
+		close(fds[1]);
+		Throughput result;
+		memset(&result, 0, sizeof(result));
+		ssize_t bytes = read(fds[0], &result, sizeof(result));
+		close(fds[0]);
+		int status = 0;
+		waitpid(pid, &status, 0);
+		if (bytes != (ssize_t)sizeof(result))
+		{
+			fprintf(stderr, "benchmark with %zu timers failed\n", count);
+			exit(1);
+		}
+		return result;
+#endif
+	}
+
+	void FillPercentiles(std::vector<long long>& lateness, Latency* result)
+	{
+		if (lateness.empty())
+		{
+			return;
+		}
+		std::sort(lateness.begin(), lateness.end());
+		size_t last = lateness.size() - 1;
+		result->min_us = lateness[0] / 1000.0;
+		result->p50_us = lateness[last * 50 / 100] / 1000.0;
+		result->p99_us = lateness[last * 99 / 100] / 1000.0;
+		result->p999_us = lateness[last * 999 / 1000] / 1000.0;
+		result->max_us = lateness[last] / 1000.0;
+	}
+
+	/*ӳ = صʼִеʱ - ĵʱ.
+	*ʱ200ms֮1ھȵ,Ӷʱĺʱӳ.
+	*slow_callbacksΪtrueʱÿ100صһ50ms,dispatch_threads>0ʱصִ߳.
+	*saturateΪtrueʱʱ200ms֮10msڵ,ÿصæ20us,ִ߳,ַл*/
+	Latency BenchUtilityLatency(size_t count, int dispatch_threads = 0, bool slow_callbacks = false, bool saturate = false)
+	{
+		Latency result = { saturate ? "utility::TimerThread(dispatch,saturated)" :
+			dispatch_threads > 0 ? "utility::TimerThread(dispatch)" : "utility::TimerThread", count, 0, 0, 0, 0, 0 };
+		std::vector<unsigned> intervals = MakeIntervals(count, 200, saturate ? 10 : 1000, 2);
+		std::vector<unsigned long long> deadlines(count);
+		std::vector<long long> lateness(count);
+		std::atomic<size_t> fired(0);
+
+		utility::TimerThread timer_thread(1);
+		timer_thread.SetDispatchThreads(dispatch_threads);
+		timer_thread.StartTimerThread();
+		for (size_t i = 0; i < count; i++)
+		{
+			deadlines[i] = NowNs() + intervals[i] * 1000000ULL;
+			long long* slot = &lateness[i];
+			const unsigned long long* deadline = &deadlines[i];
+			bool slow = slow_callbacks && i % 100 == 0;
+			timer_thread.SetATimer([slot, deadline, slow, saturate, &fired]() {
+				unsigned long long now = NowNs();
+				*slot = (long long)(now - *deadline);
+				while (saturate && NowNs() - now < 20000)
+				{
+				}
+				fired.fetch_add(1, std::memory_order_release);
+				if (slow)
+				{
+					SleepMs(50);
+				}
+			}, intervals[i], utility::ONCE);
+		}
+		while (fired.load(std::memory_order_acquire) < count)
+		{
+			SleepMs(10);
+		}
+		timer_thread.StopTimerThread();
+		FillPercentiles(lateness, &result);
+		return result;
+	}
+
+	//timer_wheel.hTimerManagerû߳,ɵ÷ѭ,ÿμ֮100us
+	Latency BenchWheelLatency(size_t count)
+	{
+		Latency result = { "timer_wheel::TimerManager", count, 0, 0, 0, 0, 0 };
+		std::vector<unsigned> intervals = MakeIntervals(count, 200, 1000, 2);
+		std::vector<unsigned long long> deadlines(count);
+		std::vector<long long> lateness(count);
+		size_t fired = 0;
+
+		WheelTimerManager manager;
+		std::vector<Timer*> timers(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			deadlines[i] = NowNs() + intervals[i] * 1000000ULL;
+			long long* slot = &lateness[i];
+			const unsigned long long* deadline = &deadlines[i];
+			timers[i] = new Timer(manager);
+			timers[i]->Start([slot, deadline, &fired]() {
+				*slot = (long long)(NowNs() - *deadline);
+				fired++;
+			}, intervals[i], Timer::ONCE);
+		}
+		while (fired < count)
+		{
+			manager.DetectTimers();
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			delete timers[i];
+		}
+		FillPercentiles(lateness, &result);
+		return result;
+	}
+
+	void PrintLatency(const char* name, const std::vector<Latency>& latency, bool last)
+	{
+		printf("  \"%s\": [\n", name);
+		for (size_t i = 0; i < latency.size(); i++)
+		{
+			const Latency& l = latency[i];
+			printf("    {\"manager\": \"%s\", \"timers\": %zu, \"min_us\": %.1f, \"p50_us\": %.1f, \"p99_us\": %.1f, "
+				"\"p999_us\": %.1f, \"max_us\": %.1f}%s\n",
+				l.manager, l.timers, l.min_us, l.p50_us, l.p99_us, l.p999_us, l.max_us,
+				i + 1 < latency.size() ? "," : "");
+		}
+		printf("  ]%s\n", last ? "" : ",");
+	}
+
+	//ϲ¶Ѳʱʱ,һֱʱΪԸ,һֱʱΪ0
+	size_t FindCrossover(const std::vector<QueueMix>& mixes)
+	{
+		size_t crossover = 0;
+		for (size_t i = 0; i + 1 < mixes.size(); i += 2)
+		{
+			if (mixes[i].mix_ns <= mixes[i + 1].mix_ns)
+			{
+				crossover = mixes[i].timers;
+			}
+			else
+			{
+				break;
+			}
+		}
+		return crossover;
+	}
+
+	void PrintQueueMix(const char* name, const std::vector<QueueMix>& mixes)
+	{
+		printf("  \"%s\": [\n", name);
+		for (size_t i = 0; i < mixes.size(); i++)
+		{
+			const QueueMix& m = mixes[i];
+			printf("    {\"queue\": \"%s\", \"timers\": %zu, \"arm_cancel_ns_per_op\": %.1f, \"fire_ns_per_op\": %.1f, "
+				"\"mix_ns_per_op\": %.1f}%s\n",
+				m.queue, m.timers, m.arm_cancel_ns, m.fire_ns, m.mix_ns, i + 1 < mixes.size() ? "," : "");
+		}
+		printf("  ],\n");
+	}
+
+	void PrintJson(const std::vector<Throughput>& throughput, const std::vector<Latency>& latency,
+		const std::vector<Latency>& slow_latency, const std::vector<QueueMix>& mixes,
+		const std::vector<QueueMix>& cold_mixes, size_t max_timers, size_t latency_max_timers)
+	{
+		printf("{\n");
+		printf("  \"benchmark\": \"timer\",\n");
+		printf("  \"config\": {\"max_timers\": %zu, \"latency_max_timers\": %zu, \"tick_ms\": 1},\n",
+			max_timers, latency_max_timers);
+		printf("  \"throughput\": [\n");
+		for (size_t i = 0; i < throughput.size(); i++)
+		{
+			const Throughput& t = throughput[i];
+			printf("    {\"manager\": \"%s\", \"timers\": %zu, \"arm_ns_per_op\": %.1f, \"reschedule_ns_per_op\": %.1f, "
+				"\"cancel_ns_per_op\": %.1f, \"fire_ns_per_op\": %.1f, \"bytes_per_timer\": %.1f}%s\n",
+				t.manager, t.timers, t.arm_ns, t.reschedule_ns, t.cancel_ns, t.fire_ns, t.bytes_per_timer,
+				i + 1 < throughput.size() ? "," : "");
+		}
+		printf("  ],\n");
+		PrintLatency("latency", latency, false);
+		PrintLatency("slow_callback_latency", slow_latency, false);
+		PrintQueueMix("queue_mix", mixes);
+		printf("  \"heap_crossover_timers\": %zu,\n", FindCrossover(mixes));
+		PrintQueueMix("cold_queue_mix", cold_mixes);
+		printf("  \"cold_heap_crossover_timers\": %zu,\n", FindCrossover(cold_mixes));
+		utility::TimerStatsSnapshot stats;
+		utility::TimerStats::GetSnapshot(&stats);
+		printf("  \"timer_stats\": %s\n", stats.ToJson().c_str());
+		printf("}\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t max_timers = 1000000;
+	size_t latency_max_timers = 100000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--max-timers") == 0 && i + 1 < argc)
+		{
+			max_timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--latency-max-timers") == 0 && i + 1 < argc)
+		{
+			latency_max_timers = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--max-timers N] [--latency-max-timers N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<Throughput> throughput;
+	std::vector<Latency> latency;
+	for (size_t count = 1000; count <= max_timers; count *= 10)
+	{
+		throughput.push_back(RunIsolated(BenchUtilityManager, count));
+		throughput.push_back(RunIsolated(BenchWheelManager, count));
+	}
+	for (size_t count = 1000; count <= latency_max_timers; count *= 10)
+	{
+		latency.push_back(BenchUtilityLatency(count));
+		latency.push_back(BenchWheelLatency(count));
+	}
+	//1000ʱ1ڵ,10ص50ms
+	std::vector<Latency> slow_latency;
+	slow_latency.push_back(BenchUtilityLatency(1000, 0, true));
+	slow_latency.push_back(BenchUtilityLatency(1000, 4, true));
+	//20000ʱ10msڵ,ζʱĻصһ,ַĲһͶ
+	slow_latency.push_back(BenchUtilityLatency(20000, 1, false, true));
+	//ǰʱںɶ,3,ȡСֵԼٸ;Ȼȵ,
+	std::vector<QueueMix> mixes[2];
+	for (int cold = 0; cold < 2; cold++)
+	{
+		for (size_t count = 8; count <= 16384; count *= 2)
+		{
+			QueueMix heap = BenchQueueMix(count, utility::TIMER_QUEUE_HEAP, cold != 0);
+			QueueMix wheel = BenchQueueMix(count, utility::TIMER_QUEUE_WHEEL, cold != 0);
+			for (int round = 1; round < 3; round++)
+			{
+				KeepFaster(heap, BenchQueueMix(count, utility::TIMER_QUEUE_HEAP, cold != 0));
+				KeepFaster(wheel, BenchQueueMix(count, utility::TIMER_QUEUE_WHEEL, cold != 0));
+			}
+			mixes[cold].push_back(heap);
+			mixes[cold].push_back(wheel);
+		}
+	}
+	PrintJson(throughput, latency, slow_latency, mixes[0], mixes[1], max_timers, latency_max_timers);
+
+	//ӳΪ˵ʱǰ
+	bool early = false;
+	for (size_t i = 0; i < latency.size(); i++)
+	{
+		early = early || latency[i].min_us < 0;
+	}
+	for (size_t i = 0; i < slow_latency.size(); i++)
+	{
+		early = early || slow_latency[i].min_us < 0;
+	}
+	if (early)
+	{
+		fprintf(stderr, "timers fired before their deadline\n");
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
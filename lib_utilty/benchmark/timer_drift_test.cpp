@@ -0,0 +1,217 @@
+/***********************************************
+*ʱƯƲ,Ҫ,JSON׼,ͨʱ1.
+*1.ͣٲ:1ms̶ȵTimerManagerзһ10msѭʱ,ͣ205ms֮һDetectTimers,
+*  ʱֺͶѶӦֻһ(),һε10ms֮.
+*2.Ư:1ms̶ȵTimerThreadзһ10msѭʱ,--ticks̶(Ĭ10^5,Լ100s),¼ÿλصʱ.
+*  kλصʱöʱ֮ǰʱk,ӳٲΪ(ǰ);
+*  1%ǰ1%صӳλĲǳƯ,ܳ--drift-limit-us(Ĭ2000us).
+*  صпæ--callback-us΢,صʱۻƯ.
+*÷: timer_drift_test [--ticks N] [--callback-us N] [--drift-limit-us N]
+************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "lib_utility.h"
+
+namespace {
+
+	struct StallResult
+	{
+		const char* queue;
+		unsigned fires;
+		unsigned next_wait_ms;
+	};
+
+	struct DriftResult
+	{
+		size_t ticks;
+		size_t fires;
+		size_t early_fires;
+		size_t rebased;//֮ͣӵǰ¼Ĵ
+		double lateness_p50_us;
+		double lateness_p99_us;
+		double lateness_max_us;
+		double interval_jitter_p50_us;//λصļ֮
+		double interval_jitter_p99_us;
+		double drift_us;
+	};
+
+	enum { PERIOD_MS = 10 };
+
+	unsigned long long NowNs()
+	{
+		return utility::MonotonicClock::NowNs();
+	}
+
+	double Percentile(std::vector<long long>& values, double percent)
+	{
+		if (values.empty())
+		{
+			return 0;
+		}
+		size_t index = (size_t)(percent / 100.0 * (values.size() - 1));
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return (double)values[index];
+	}
+
+	StallResult TestStall(utility::TimerQueuePolicy policy)
+	{
+		StallResult result = { policy == utility::TIMER_QUEUE_HEAP ? "heap" : "wheel", 0, 0 };
+		utility::TimerManager manager(1);
+		manager.SetQueuePolicy(policy);
+		unsigned fires = 0;
+		utility::TimerTask* timer_task = new utility::TimerTask();
+		timer_task->SetTimerCallback(utility::TimerCallback([&fires]() { fires++; }));
+		timer_task->SetTimerTask(NULL, 10, utility::CIRCLE);
+		manager.AddTimer(timer_task);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(205));
+		manager.DetectTimers();
+		result.fires = fires;
+		result.next_wait_ms = manager.GetWaitTime();
+		manager.RemoveTimer(timer_task);
+		delete timer_task;
+		return result;
+	}
+
+	//æ,ģصĺʱ
+	void BusyWait(unsigned microseconds)
+	{
+		unsigned long long end = NowNs() + microseconds * 1000ULL;
+		while (NowNs() < end)
+		{
+		}
+	}
+
+	DriftResult TestDrift(size_t ticks, unsigned callback_us)
+	{
+		const unsigned long long period_ns = PERIOD_MS * 1000000ULL;
+		DriftResult result;
+		memset(&result, 0, sizeof(result));
+		result.ticks = ticks;
+		size_t fires = ticks / PERIOD_MS > 2 ? ticks / PERIOD_MS : 2;
+		result.fires = fires;
+
+		std::vector<unsigned long long> fire_ns(fires);
+		std::atomic<size_t> fired(0);
+		utility::TimerThread timer_thread(1);
+		timer_thread.StartTimerThread();
+		unsigned long long arm_ns = NowNs();
+		utility::TimerHandle handle = timer_thread.SetATimer([&fire_ns, &fired, fires, callback_us]() {
+			size_t index = fired.load(std::memory_order_relaxed);
+			if (index < fires)
+			{
+				fire_ns[index] = NowNs();
+				BusyWait(callback_us);
+				fired.store(index + 1, std::memory_order_release);
+			}
+		}, PERIOD_MS, utility::CIRCLE);
+		while (fired.load(std::memory_order_acquire) < fires)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		timer_thread.StopATimer(handle);
+		timer_thread.StopTimerThread();
+
+		/*kλصӦn,ʱnμ1;
+		*ӳٳһ˵ʱ߳ͣٹ,֮,һλصڵڼ*/
+		std::vector<long long> lateness(fires);
+		std::vector<long long> jitter;
+		jitter.reserve(fires);
+		unsigned long long period_index = 0;
+		bool stalled = false;
+		for (size_t k = 0; k < fires; k++)
+		{
+			period_index++;
+			if (stalled)
+			{
+				unsigned long long current = (fire_ns[k] - arm_ns) / period_ns;
+				if (current > period_index)
+				{
+					period_index = current;
+					result.rebased++;
+				}
+			}
+			long long late = (long long)(fire_ns[k] - (arm_ns + period_index * period_ns));
+			if (late < 0)
+			{
+				result.early_fires++;
+			}
+			lateness[k] = late;
+			stalled = late >= (long long)period_ns;
+			if (k > 0)
+			{
+				long long interval = (long long)(fire_ns[k] - fire_ns[k - 1]);
+				jitter.push_back(interval > (long long)period_ns ? interval - (long long)period_ns : (long long)period_ns - interval);
+			}
+		}
+
+		size_t window = fires / 100 > 10 ? fires / 100 : (fires < 10 ? fires : 10);
+		std::vector<long long> first(lateness.begin(), lateness.begin() + window);
+		std::vector<long long> last(lateness.end() - window, lateness.end());
+		result.drift_us = (Percentile(last, 50) - Percentile(first, 50)) / 1000.0;
+		result.lateness_max_us = (double)*std::max_element(lateness.begin(), lateness.end()) / 1000.0;
+		result.lateness_p50_us = Percentile(lateness, 50) / 1000.0;
+		result.lateness_p99_us = Percentile(lateness, 99) / 1000.0;
+		result.interval_jitter_p50_us = Percentile(jitter, 50) / 1000.0;
+		result.interval_jitter_p99_us = Percentile(jitter, 99) / 1000.0;
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t ticks = 100000;
+	unsigned callback_us = 0;
+	double drift_limit_us = 2000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+		{
+			ticks = (size_t)strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--callback-us") == 0 && i + 1 < argc)
+		{
+			callback_us = (unsigned)strtoul(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--drift-limit-us") == 0 && i + 1 < argc)
+		{
+			drift_limit_us = strtod(argv[++i], NULL);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--ticks N] [--callback-us N] [--drift-limit-us N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	StallResult stalls[2] = { TestStall(utility::TIMER_QUEUE_WHEEL), TestStall(utility::TIMER_QUEUE_HEAP) };
+	DriftResult drift = TestDrift(ticks, callback_us);
+
+	bool passed = drift.early_fires == 0 && drift.drift_us <= drift_limit_us && drift.drift_us >= -drift_limit_us;
+	printf("{\n");
+	printf("  \"benchmark\": \"timer_drift\",\n");
+	printf("  \"stall_catch_up\": [\n");
+	for (int i = 0; i < 2; i++)
+	{
+		bool stall_passed = stalls[i].fires == 1 && stalls[i].next_wait_ms <= 10;
+		passed = passed && stall_passed;
+		printf("    {\"queue\": \"%s\", \"stall_ms\": 205, \"interval_ms\": 10, \"fires\": %u, \"next_wait_ms\": %u, \"passed\": %s}%s\n",
+			stalls[i].queue, stalls[i].fires, stalls[i].next_wait_ms, stall_passed ? "true" : "false", i == 0 ? "," : "");
+	}
+	printf("  ],\n");
+	printf("  \"drift\": {\"ticks\": %zu, \"tick_ms\": 1, \"period_ms\": %d, \"fires\": %zu, \"callback_us\": %u, "
+		"\"early_fires\": %zu, \"rebased\": %zu, \"lateness_p50_us\": %.1f, \"lateness_p99_us\": %.1f, \"lateness_max_us\": %.1f, "
+		"\"interval_jitter_p50_us\": %.1f, \"interval_jitter_p99_us\": %.1f, \"drift_us\": %.1f, \"drift_limit_us\": %.1f},\n",
+		drift.ticks, (int)PERIOD_MS, drift.fires, callback_us, drift.early_fires, drift.rebased,
+		drift.lateness_p50_us, drift.lateness_p99_us, drift.lateness_max_us,
+		drift.interval_jitter_p50_us, drift.interval_jitter_p99_us, drift.drift_us, drift_limit_us);
+	printf("  \"passed\": %s\n", passed ? "true" : "false");
+	printf("}\n");
+	return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,505 @@
+#ifndef _HIERARCHICAL_WHEEL_H_
+#define _HIERARCHICAL_WHEEL_H_
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "monotonic_clock.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace utility {
+
+//ʽ˫ڵ,Ƕڶʱ,/ժʱֲʱҪڴ
+struct TimerWheelHook
+{
+	TimerWheelHook() : prev_(this), next_(this), expire_tick_(0), slot_(-1) {}
+
+	TimerWheelHook* prev_;
+	TimerWheelHook* next_;
+	unsigned long long expire_tick_;//ڵĿ̶
+	int slot_;//ڵĲ,ֻʱ޸
+};
+
+//ʱֵһ:ڱ˫ѭ,вΪO(1)
+class TimerWheelList
+{
+public:
+	TimerWheelList()
+	{
+		head_.prev_ = &head_;
+		head_.next_ = &head_;
+	}
+
+	bool IsEmpty() const { return head_.next_ == &head_; }
+
+	void PushBack(TimerWheelHook* node)
+	{
+		node->prev_ = head_.prev_;
+		node->next_ = &head_;
+		head_.prev_->next_ = node;
+		head_.prev_ = node;
+	}
+
+	TimerWheelHook* PopFront()
+	{
+		if (IsEmpty())
+		{
+			return NULL;
+		}
+		TimerWheelHook* node = head_.next_;
+		Unlink(node);
+		return node;
+	}
+
+	//otherеȫڵƵβ,otherΪ
+	void SpliceFrom(TimerWheelList& other)
+	{
+		if (other.IsEmpty())
+		{
+			return;
+		}
+		TimerWheelHook* first = other.head_.next_;
+		TimerWheelHook* last = other.head_.prev_;
+		first->prev_ = head_.prev_;
+		head_.prev_->next_ = first;
+		last->next_ = &head_;
+		head_.prev_ = last;
+		other.head_.prev_ = &other.head_;
+		other.head_.next_ = &other.head_;
+	}
+
+	static void Unlink(TimerWheelHook* node)
+	{
+		node->prev_->next_ = node->next_;
+		node->next_->prev_ = node->prev_;
+		node->prev_ = node;
+		node->next_ = node;
+	}
+
+	static bool IsLinked(const TimerWheelHook* node) { return node->next_ != node; }
+
+private:
+	TimerWheelList(const TimerWheelList&);
+	TimerWheelList& operator=(const TimerWheelList&);
+
+	TimerWheelHook head_;
+};
+
+/***********************************************
+*ֲʱ,βڱȷ:
+*һ2^ROOT_BITS,LEVELS2^LEVEL_BITS,
+*ʱΧΪ2^(ROOT_BITS + LEVELS * LEVEL_BITS)̶,۵±ͼλöɱڳ.
+*Χĵڿ̶ȷ߼ԶĲ,ʱʵĵڿ̶·,ǰ.
+*TICK_NSSchedule/AdvanceʱʹõĿ̶ȳ;
+*Insert/AdvanceToֱʹÿ̶,̶ȳɵ÷(TimerManagerʱָ).
+*ֻһ߳ʹ.:
+*	TimerWheel<1000000ULL, 8, 4, 3>		1ms̶,ʱΧԼ17,ʺ糬ʱ
+*	TimerWheel<1000000000ULL, 6, 6, 3>	1s̶,ʱΧԼ194,ʺϻỰ
+************************************************/
+template <unsigned long long TICK_NS, int ROOT_BITS, int LEVEL_BITS, int LEVELS>
+class TimerWheel
+{
+	static_assert(TICK_NS > 0, "tick must not be zero");
+	static_assert(ROOT_BITS >= 6 && ROOT_BITS <= 16, "root wheel must fill whole bitmap words");
+	static_assert(LEVEL_BITS >= 1 && LEVEL_BITS <= 6, "an upper wheel must fit in one bitmap word");
+	static_assert(LEVELS >= 1 && ROOT_BITS + LEVELS * LEVEL_BITS <= 62, "wheel span is limited to 2^62 ticks");
+
+public:
+	enum
+	{
+		ROOT_SIZE = 1 << ROOT_BITS,
+		ROOT_MASK = ROOT_SIZE - 1,
+		LEVEL_SIZE = 1 << LEVEL_BITS,
+		LEVEL_MASK = LEVEL_SIZE - 1,
+		SPAN_BITS = ROOT_BITS + LEVELS * LEVEL_BITS,
+		SLOT_COUNT = ROOT_SIZE + LEVELS * LEVEL_SIZE,
+		BITMAP_WORDS = (SLOT_COUNT + 63) / 64,
+		WHEEL_LEVELS = LEVELS + 1//һ
+	};
+	static const unsigned long long MAX_SPAN = (1ULL << SPAN_BITS) - 1;//ֱӷԶ̶Ȳ
+
+	explicit TimerWheel(unsigned long long start_tick = 0)
+		: current_tick_(start_tick), count_(0), start_ns_(MonotonicClock::NowNs())
+	{
+		memset(slot_bitmap_, 0, sizeof(slot_bitmap_));
+	}
+
+	//node->expire_tick_ʱ,ڵĲ
+	int Insert(TimerWheelHook* node)
+	{
+		int slot = GetSlotIndex(node->expire_tick_, current_tick_);
+		node->slot_ = slot;
+		slots_[slot].PushBack(node);
+		SetSlotBit(slot);
+		++count_;
+		return slot;
+	}
+
+	//:۷ÿһƴӵ,ͬһڱԭ˳
+	template <class Node>
+	void InsertBatch(Node** nodes, int count)
+	{
+		std::vector<std::pair<int, int> > slots(count);//(,nodesеλ)
+		for (int i = 0; i < count; i++)
+		{
+			slots[i].first = GetSlotIndex(nodes[i]->expire_tick_, current_tick_);
+			slots[i].second = i;
+		}
+		std::sort(slots.begin(), slots.end());
+		for (int i = 0; i < count; )
+		{
+			int slot = slots[i].first;
+			TimerWheelList group;
+			for (; i < count && slots[i].first == slot; i++)
+			{
+				TimerWheelHook* node = nodes[slots[i].second];
+				node->slot_ = slot;
+				group.PushBack(node);
+			}
+			slots_[slot].SpliceFrom(group);
+			SetSlotBit(slot);
+		}
+		count_ += count;
+	}
+
+	//ʱʱʲôҲ
+	void Remove(TimerWheelHook* node)
+	{
+		if (TimerWheelList::IsLinked(node))
+		{
+			TimerWheelList::Unlink(node);
+			--count_;
+			if (slots_[node->slot_].IsEmpty())
+			{
+				ClearSlotBit(node->slot_);
+			}
+		}
+	}
+
+	//ժ,ÿֻһǷѿ,ʵժĸ
+	template <class Node>
+	int RemoveBatch(Node** nodes, int count)
+	{
+		std::vector<int> touched_slots;
+		touched_slots.reserve(count);
+		int removed = 0;
+		for (int i = 0; i < count; i++)
+		{
+			TimerWheelHook* node = nodes[i];
+			if (TimerWheelList::IsLinked(node))
+			{
+				TimerWheelList::Unlink(node);
+				--count_;
+				touched_slots.push_back(node->slot_);
+				removed++;
+			}
+		}
+		std::sort(touched_slots.begin(), touched_slots.end());
+		touched_slots.erase(std::unique(touched_slots.begin(), touched_slots.end()), touched_slots.end());
+		for (size_t i = 0; i < touched_slots.size(); i++)
+		{
+			if (slots_[touched_slots[i]].IsEmpty())
+			{
+				ClearSlotBit(touched_slots[i]);
+			}
+		}
+		return removed;
+	}
+
+	static bool IsLinked(const TimerWheelHook* node) { return TimerWheelList::IsLinked(node); }
+
+	/*now_tick()Ϊֹп̶,òλͼֱյĿ̶.
+	*handler.OnCascade(node)ڼĽڵ·֮ǰ,޸ĵڿ̶;
+	*handler.OnExpire(node)ڽڵ㵽ʱ,ڵѾʱժ,·*/
+	template <class Handler>
+	void AdvanceTo(unsigned long long now_tick, Handler& handler)
+	{
+		while (current_tick_ <= now_tick)
+		{
+			unsigned long long next_tick = 0;
+			if (!GetNextPendingTick(&next_tick) || next_tick > now_tick)
+			{
+				current_tick_ = now_tick + 1;
+				break;
+			}
+			current_tick_ = next_tick;
+
+			int index = (int)(current_tick_ & ROOT_MASK);
+			if (index == 0)
+			{
+				//λȫΪ0ʱμ,Ĳ۲0ʱ߼Ҫ
+				for (int level = 0; level < LEVELS; level++)
+				{
+					int level_index = (int)((current_tick_ >> LevelShift(level)) & LEVEL_MASK);
+					Cascade(LevelOffset(level) + level_index, handler);
+					if (level_index != 0)
+					{
+						break;
+					}
+				}
+			}
+			current_tick_ += 1;
+
+			TimerWheelList temp;
+			temp.SpliceFrom(slots_[index]);
+			ClearSlotBit(index);
+			while (!temp.IsEmpty())
+			{
+				TimerWheelHook* node = temp.PopFront();
+				--count_;
+				handler.OnExpire(node);
+			}
+		}
+	}
+
+	//һҪĿ̶(жʱڻҪ),ûжʱʱfalse
+	bool GetNextPendingTick(unsigned long long* next_tick) const
+	{
+		if (count_ == 0)
+		{
+			return false;
+		}
+
+		/*һʱеĶʱ۵˳,ҵĵһǿղ۾ĵڿ̶*/
+		unsigned long long min_tick = ~0ULL;
+		const int root_words = ROOT_SIZE / 64;
+		int root_index = (int)(current_tick_ & ROOT_MASK);
+		for (int i = 0; i <= root_words; i++)
+		{
+			int word = ((root_index >> 6) + i) % root_words;
+			unsigned long long bitmap = slot_bitmap_[word];
+			if (i == 0)
+			{
+				bitmap &= ~0ULL << (root_index & 63);
+			}
+			else if (i == root_words)
+			{
+				bitmap &= ~(~0ULL << (root_index & 63));
+			}
+			if (bitmap != 0)
+			{
+				int slot = word * 64 + FindFirstSetBit(bitmap);
+				min_tick = current_tick_ + ((slot - root_index) & ROOT_MASK);
+				break;
+			}
+		}
+
+		/*߼ʱеĶʱҪڵĲۼ֮Ż䵽һ,
+		*NĵkڵλȫΪ0ҵN±ΪkĿ̶ϼ*/
+		for (int level = 0; level < LEVELS; level++)
+		{
+			int offset = LevelOffset(level);
+			unsigned long long bitmap = (slot_bitmap_[offset >> 6] >> (offset & 63)) & LevelBitmapMask();
+			if (bitmap == 0)
+			{
+				continue;
+			}
+			int shift = LevelShift(level);
+			unsigned long long cycle = 1ULL << (shift + LEVEL_BITS);
+			int start_index = (int)((current_tick_ >> shift) & LEVEL_MASK);
+			if ((current_tick_ & ((1ULL << shift) - 1)) != 0)
+			{
+				//ǰĲѾ,ҪһȦ
+				start_index = (start_index + 1) & LEVEL_MASK;
+			}
+			unsigned long long high = bitmap & (~0ULL << start_index);
+			int slot = FindFirstSetBit(high != 0 ? high : bitmap);
+			unsigned long long cascade_tick = (current_tick_ & ~(cycle - 1)) + ((unsigned long long)slot << shift);
+			if (cascade_tick < current_tick_)
+			{
+				cascade_tick += cycle;
+			}
+			if (cascade_tick < min_tick)
+			{
+				min_tick = cascade_tick;
+			}
+		}
+
+		*next_tick = min_tick;
+		return true;
+	}
+
+	unsigned long long GetCurrentTick() const { return current_tick_; }//һҪĿ̶
+	size_t GetCount() const { return count_; }
+
+	//levelķǿղ,0ǵһ,1~LEVELSǸ߼ʱ
+	int GetOccupiedSlots(int level) const
+	{
+		int count = 0;
+		if (level == 0)
+		{
+			for (int word = 0; word < ROOT_SIZE / 64; word++)
+			{
+				count += PopCount(slot_bitmap_[word]);
+			}
+			return count;
+		}
+		int offset = LevelOffset(level - 1);
+		return PopCount((slot_bitmap_[offset >> 6] >> (offset & 63)) & LevelBitmapMask());
+	}
+
+	/*ʱĽӿ:̶ȴӹʱĵʱʱ俪ʼ,ΪTICK_NS*/
+	unsigned long long GetNowTick() const { return (MonotonicClock::NowNs() - start_ns_) / TICK_NS; }
+
+	//delay_ns֮ڵĿ̶,ȡ,ǰ.ֻȡʱʱ,̵߳
+	unsigned long long GetDeadlineTick(unsigned long long delay_ns) const
+	{
+		unsigned long long deadline = MonotonicClock::NowNs() - start_ns_ + delay_ns;
+		return (deadline + TICK_NS - 1) / TICK_NS;
+	}
+
+	int Schedule(TimerWheelHook* node, unsigned long long delay_ns)
+	{
+		node->expire_tick_ = GetDeadlineTick(delay_ns);
+		return Insert(node);
+	}
+
+	//ǰʱΪֹеڵĽڵ,ÿڵon_expire(node)
+	template <class F>
+	void Advance(F&& on_expire)
+	{
+		ExpireAdapter<F> handler(on_expire);
+		AdvanceTo(GetNowTick(), handler);
+	}
+
+	//һҪĿ̶ȵ,ûжʱʱfalse
+	bool GetNextExpireNs(unsigned long long* wait_ns) const
+	{
+		unsigned long long next_tick = 0;
+		if (!GetNextPendingTick(&next_tick))
+		{
+			return false;
+		}
+		unsigned long long next_ns = start_ns_ + next_tick * TICK_NS;
+		unsigned long long now = MonotonicClock::NowNs();
+		*wait_ns = next_ns > now ? next_ns - now : 0;
+		return true;
+	}
+
+	//ڿ̶current_tickڵĲ,ʱΧʱԶĿ̶ȼ
+	static int GetSlotIndex(unsigned long long expire_tick, unsigned long long current_tick)
+	{
+		unsigned long long diff = expire_tick - current_tick;
+		if ((long long)diff < 0)
+		{
+			//Ѿ,ŵһҪĲ
+			return (int)(current_tick & ROOT_MASK);
+		}
+		if (diff < ROOT_SIZE)
+		{
+			return (int)(expire_tick & ROOT_MASK);
+		}
+		if (diff > MAX_SPAN)
+		{
+			diff = MAX_SPAN;
+			expire_tick = current_tick + MAX_SPAN;
+		}
+		//̶Ȳλڵļ:N[2^(ROOT_BITS+N*LEVEL_BITS), 2^(ROOT_BITS+(N+1)*LEVEL_BITS))
+		int level = (FindLastSetBit(diff) - ROOT_BITS) / LEVEL_BITS;
+		return LevelOffset(level) + (int)((expire_tick >> LevelShift(level)) & LEVEL_MASK);
+	}
+
+private:
+	TimerWheel(const TimerWheel&);
+	TimerWheel& operator=(const TimerWheel&);
+
+	template <class F>
+	struct ExpireAdapter
+	{
+		explicit ExpireAdapter(F& func) : func_(func) {}
+		void OnCascade(TimerWheelHook*) {}
+		void OnExpire(TimerWheelHook* node) { func_(node); }
+		F& func_;
+	};
+
+	static int LevelOffset(int level) { return ROOT_SIZE + level * LEVEL_SIZE; }
+	static int LevelShift(int level) { return ROOT_BITS + level * LEVEL_BITS; }
+	static unsigned long long LevelBitmapMask() { return LEVEL_SIZE == 64 ? ~0ULL : (1ULL << LEVEL_SIZE) - 1; }
+
+	template <class Handler>
+	void Cascade(int slot, Handler& handler)
+	{
+		TimerWheelList temp;
+		temp.SpliceFrom(slots_[slot]);
+		ClearSlotBit(slot);
+		while (!temp.IsEmpty())
+		{
+			TimerWheelHook* node = temp.PopFront();
+			--count_;
+			handler.OnCascade(node);
+			Insert(node);
+		}
+	}
+
+	void SetSlotBit(int slot) { slot_bitmap_[slot >> 6] |= 1ULL << (slot & 63); }
+	void ClearSlotBit(int slot) { slot_bitmap_[slot >> 6] &= ~(1ULL << (slot & 63)); }
+
+	//bitmapΪ0
+	static int FindFirstSetBit(unsigned long long bitmap)
+	{
+#if defined(_MSC_VER)
+		unsigned long bit = 0;
+#if defined(_M_X64) || defined(_M_ARM64)
+		_BitScanForward64(&bit, bitmap);
+#else
+		if (!_BitScanForward(&bit, (unsigned long)bitmap))
+		{
+			_BitScanForward(&bit, (unsigned long)(bitmap >> 32));
+			bit += 32;
+		}
+#endif
+		return (int)bit;
+#else
+		return __builtin_ctzll(bitmap);
+#endif
+	}
+
+	static int PopCount(unsigned long long bitmap)
+	{
+		int count = 0;
+		while (bitmap != 0)
+		{
+			bitmap &= bitmap - 1;
+			count++;
+		}
+		return count;
+	}
+
+	static int FindLastSetBit(unsigned long long value)
+	{
+#if defined(_MSC_VER)
+		unsigned long bit = 0;
+#if defined(_M_X64) || defined(_M_ARM64)
+		_BitScanReverse64(&bit, value);
+#else
+		if (_BitScanReverse(&bit, (unsigned long)(value >> 32)))
+		{
+			bit += 32;
+		}
+		else
+		{
+			_BitScanReverse(&bit, (unsigned long)value);
+		}
+#endif
+		return (int)bit;
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+
+	TimerWheelList slots_[SLOT_COUNT];
+	//ÿһλ,Ϊ1ʾ۷ǿ
+	unsigned long long slot_bitmap_[BITMAP_WORDS];
+	unsigned long long current_tick_;
+	size_t count_;
+	unsigned long long start_ns_;
+};
+
+template <unsigned long long TICK_NS, int ROOT_BITS, int LEVEL_BITS, int LEVELS>
+const unsigned long long TimerWheel<TICK_NS, ROOT_BITS, LEVEL_BITS, LEVELS>::MAX_SPAN;
+
+}
+#endif //_HIERARCHICAL_WHEEL_H_
\ No newline at end of file
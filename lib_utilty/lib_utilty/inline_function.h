@@ -0,0 +1,171 @@
+#ifndef _INLINE_FUNCTION_H_
+#define _INLINE_FUNCTION_H_
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace utility {
+
+/*޲޷ֵĿɵö,BUFFER_SIZEĶֱӷڲ,ڴ.
+*ָͨ,û麯;ĶڶϷ.
+*ֻƶܸ,ҲԱֻƶlambda.
+*/
+template <size_t BUFFER_SIZE = 48>
+class InlineFunction
+{
+public:
+	InlineFunction() : invoke_(NULL), manage_(NULL) {}
+
+	template <class F, class = typename std::enable_if<
+		!std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+	InlineFunction(F&& func) : invoke_(NULL), manage_(NULL)
+	{
+		Assign(std::forward<F>(func));
+	}
+
+	InlineFunction(InlineFunction&& other) : invoke_(NULL), manage_(NULL)
+	{
+		MoveFrom(other);
+	}
+
+	~InlineFunction()
+	{
+		Reset();
+	}
+
+	InlineFunction& operator=(InlineFunction&& other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			MoveFrom(other);
+		}
+		return *this;
+	}
+
+	template <class F, class = typename std::enable_if<
+		!std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+	InlineFunction& operator=(F&& func)
+	{
+		Reset();
+		Assign(std::forward<F>(func));
+		return *this;
+	}
+
+	void operator()()
+	{
+		invoke_(&storage_);
+	}
+
+	bool IsEmpty() const { return invoke_ == NULL; }
+	explicit operator bool() const { return invoke_ != NULL; }
+
+	void Reset()
+	{
+		if (manage_ != NULL)
+		{
+			manage_(&storage_, NULL);
+		}
+		invoke_ = NULL;
+		manage_ = NULL;
+	}
+
+private:
+	InlineFunction(const InlineFunction&);
+	InlineFunction& operator=(const InlineFunction&);
+
+	union Storage
+	{
+		char buffer[BUFFER_SIZE];
+		void* pointer;
+		long double align_double;
+		long long align_integer;
+	};
+
+	//Fܷڲ
+	template <class F>
+	struct IsInline
+	{
+		static const bool value = sizeof(F) <= BUFFER_SIZE &&
+			std::alignment_of<F>::value <= std::alignment_of<Storage>::value &&
+			std::is_nothrow_move_constructible<F>::value;
+	};
+
+	typedef void(*InvokeFunc)(void* storage);
+	//dstΪNULLʱsrc,srcƶdstsrc
+	typedef void(*ManageFunc)(void* src, void* dst);
+
+	template <class F>
+	struct InlineOps
+	{
+		static void Invoke(void* storage) { (*(F*)storage)(); }
+		static void Manage(void* src, void* dst)
+		{
+			if (dst != NULL)
+			{
+				new (dst) F(std::move(*(F*)src));
+			}
+			((F*)src)->~F();
+		}
+	};
+
+	template <class F>
+	struct HeapOps
+	{
+		static void Invoke(void* storage) { (**(F**)storage)(); }
+		static void Manage(void* src, void* dst)
+		{
+			if (dst != NULL)
+			{
+				*(F**)dst = *(F**)src;
+			}
+			else
+			{
+				delete *(F**)src;
+			}
+		}
+	};
+
+	template <class F>
+	void Assign(F&& func)
+	{
+		typedef typename std::decay<F>::type Func;
+		Construct<Func>(std::forward<F>(func), std::integral_constant<bool, IsInline<Func>::value>());
+	}
+
+	template <class Func, class F>
+	void Construct(F&& func, std::true_type)
+	{
+		new (&storage_) Func(std::forward<F>(func));
+		invoke_ = &InlineOps<Func>::Invoke;
+		manage_ = &InlineOps<Func>::Manage;
+	}
+
+	template <class Func, class F>
+	void Construct(F&& func, std::false_type)
+	{
+		storage_.pointer = new Func(std::forward<F>(func));
+		invoke_ = &HeapOps<Func>::Invoke;
+		manage_ = &HeapOps<Func>::Manage;
+	}
+
+	void MoveFrom(InlineFunction& other)
+	{
+		if (other.manage_ != NULL)
+		{
+			other.manage_(&other.storage_, &storage_);
+		}
+		invoke_ = other.invoke_;
+		manage_ = other.manage_;
+		other.invoke_ = NULL;
+		other.manage_ = NULL;
+	}
+
+	Storage storage_;
+	InvokeFunc invoke_;
+	ManageFunc manage_;
+};
+
+}
+#endif //_INLINE_FUNCTION_H_
\ No newline at end of file
@@ -1,12 +1,41 @@
 #include "lib_utility.h"
+#include "timer_stats.h"
 #include <chrono>
 #include <iostream>
+#include <string.h>
+#include <new>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#pragma comment(lib, "Synchronization.lib")
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
 namespace utility {
-	CommonMutex::CommonMutex(std::string mutex_name)
+#ifdef _WIN32
+	CommonMutex::CommonMutex(std::string mutex_name, MutexMode mutex_mode)
+		: mutex_mode_(mutex_mode), lock_state_(0)
 	{
 #ifndef MULTIPROCESS
 		InitializeCriticalSection(&thread_lock_);
 #else
+		if (mutex_name != "")
+		{
+			mutex_mode_ = MUTEX_DEFAULT;
+		}
 		mutex_name_ = mutex_name;
 		mutex_handle_ = CreateMutex(NULL, FALSE, (mutex_name_ != "") ? mutex_name_.c_str() : NULL);
 #endif
@@ -23,6 +52,10 @@ namespace utility {
 
 	bool CommonMutex::LockObject(void)
 	{
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			return AdaptiveLock(-1);
+		}
 #ifndef MULTIPROCESS
 		EnterCriticalSection(&thread_lock_);
 #else
@@ -39,8 +72,61 @@ namespace utility {
 		return TRUE;
 	}
 
+	bool CommonMutex::TryLockObject(void)
+	{
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			return AdaptiveLock(0);
+		}
+#ifndef MULTIPROCESS
+		return TryEnterCriticalSection(&thread_lock_) != FALSE;
+#else
+		if (NULL == mutex_handle_)
+		{
+			return FALSE;
+		}
+		return WaitForSingleObject(mutex_handle_, 0) == WAIT_OBJECT_0;
+#endif
+	}
+
+	bool CommonMutex::TimedLockObject(int nMillonSecond)
+	{
+		if (nMillonSecond < 0)
+		{
+			nMillonSecond = 0;
+		}
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			return AdaptiveLock(nMillonSecond);
+		}
+#ifndef MULTIPROCESS
+		/*CRITICAL_SECTIONûгʱȴ,ֻܷ*/
+		ULONGLONG deadline = GetTickCount64() + nMillonSecond;
+		while (!TryEnterCriticalSection(&thread_lock_))
+		{
+			if (GetTickCount64() >= deadline)
+			{
+				return FALSE;
+			}
+			Sleep(1);
+		}
+		return TRUE;
+#else
+		if (NULL == mutex_handle_)
+		{
+			return FALSE;
+		}
+		return WaitForSingleObject(mutex_handle_, nMillonSecond) == WAIT_OBJECT_0;
+#endif
+	}
+
 	bool CommonMutex::UnlockObject(void)
 	{
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			AdaptiveUnlock();
+			return TRUE;
+		}
 #ifndef MULTIPROCESS
 		LeaveCriticalSection(&thread_lock_);
 		return TRUE;
@@ -146,254 +232,2702 @@ namespace utility {
 		return  ReleaseSemaphore(semaphore_handle_, 1, NULL);
 	}
 
-
-	SystemTime::SystemTime(void)
+	CommonRWLock::CommonRWLock(bool prefer_writer)
+		: prefer_writer_(prefer_writer), waiting_writers_(0)
 	{
-		LARGE_INTEGER fc;
-
-		if (!QueryPerformanceFrequency(&fc))
-		{
-			assert(FALSE);
-		}
-		frequency_ = (DOUBLE)fc.QuadPart;  //ʱƵ
+		InitializeSRWLock(&rw_lock_);
 	}
 
-	SystemTime::~SystemTime(void)
+	CommonRWLock::~CommonRWLock()
 	{
 	}
 
-	unsigned long long SystemTime::GetCurrentMilliseconds()
+	bool CommonRWLock::LockShared(void)
 	{
-		assert(frequency_ > 1000);
-		LARGE_INTEGER fc;
-		if (!QueryPerformanceCounter(&fc))
+		if (prefer_writer_)
 		{
-			assert(FALSE);
+			/*дڵȴʱwaiting_writers_,һȴдõ֮,
+			*֮SRWLOCKϵдͷ*/
+			int writers = waiting_writers_.load(std::memory_order_acquire);
+			while (writers > 0)
+			{
+				WaitOnAddress(&waiting_writers_, &writers, sizeof(int), INFINITE);
+				writers = waiting_writers_.load(std::memory_order_acquire);
+			}
 		}
+		AcquireSRWLockShared(&rw_lock_);
+		return TRUE;
+	}
 
-		return unsigned long long((fc.QuadPart) / (frequency_ /1000));
+	bool CommonRWLock::TryLockShared(void)
+	{
+		if (prefer_writer_ && waiting_writers_.load(std::memory_order_acquire) > 0)
+		{
+			return FALSE;
+		}
+		return TryAcquireSRWLockShared(&rw_lock_) != FALSE;
 	}
 
-	TimerTask::TimerTask()
+	bool CommonRWLock::UnlockShared(void)
 	{
-		interval_time_ = 0;
-		vect_index_ = -1;
-		timer_notify_ = NULL;
-		timer_type_ = CIRCLE;
+		ReleaseSRWLockShared(&rw_lock_);
+		return TRUE;
 	}
 
-	TimerTask::~TimerTask()
+	bool CommonRWLock::LockExclusive(void)
 	{
-		if (timer_notify_ != NULL)
+		waiting_writers_.fetch_add(1, std::memory_order_acq_rel);
+		AcquireSRWLockExclusive(&rw_lock_);
+		if (waiting_writers_.fetch_sub(1, std::memory_order_acq_rel) == 1 && prefer_writer_)
 		{
-			delete timer_notify_;
+			WakeByAddressAll(&waiting_writers_);
 		}
+		return TRUE;
 	}
 
-	void TimerTask::SetTimerTask(TimerNotify* timer_notify, unsigned interval, TimerType timer_type)
+	bool CommonRWLock::TryLockExclusive(void)
 	{
-		interval_time_ = interval;
-		timer_notify_ = timer_notify;
-		timer_type_ = timer_type;
+		return TryAcquireSRWLockExclusive(&rw_lock_) != FALSE;
 	}
 
-	unsigned TimerTask::GetIntervalTime()
+	bool CommonRWLock::UnlockExclusive(void)
 	{
-		return interval_time_;
+		ReleaseSRWLockExclusive(&rw_lock_);
+		return TRUE;
 	}
-	void TimerTask::SetVectorIndex(int vect_index)
-	{
-		vect_index_ = vect_index;
+
+
+#else
+	namespace {
+		/*Ĺڴ(shm_open),ͷ¼ʼ״̬.
+		*ڴ治һʹ߹رնɾ(sem_openźһһֱshm_unlink),
+		*һܴ̿һɾĶ,֮Ľִµͬ.
+		*򿪺ͳʼڼԹڴflock,ڳʼ֮ǰ˳ʱԶͷ,һ³ʼ.
+		*ȨΪ0600,ֻͬһûĽ̿Դ*/
+		enum { SHARED_OBJECT_MODE = 0600, SHARED_OBJECT_READY = 2, SHARED_OBJECT_WAIT_MS = 5000 };
+
+		struct SharedObjectHeader
+		{
+			std::atomic<int> init_state;//0:δʼ 2:ʼ
+		};
+
+		//ʼ,ֻɵһڳflockʱ
+		typedef void (*SharedObjectInit)(void* object, void* context);
+
+		std::string SharedObjectPath(const char* type_name, const std::string& object_name)
+		{
+			std::string path = std::string("/lib_utility_") + type_name + "_";
+			for (size_t i = 0; i < object_name.size(); i++)
+			{
+				path += (object_name[i] == '/') ? '_' : object_name[i];
+			}
+			return path;
+		}
+
+		//򿪻򴴽,ͷ֮ĵַ.̳ʼ5߳ʱNULL
+		void* OpenSharedObject(const std::string& path, size_t object_size, SharedObjectInit init, void* context)
+		{
+			size_t total_size = sizeof(SharedObjectHeader) + object_size;
+			int fd = shm_open(path.c_str(), O_RDWR | O_CREAT, SHARED_OBJECT_MODE);
+			if (fd < 0)
+			{
+				return NULL;
+			}
+			//ȴɳʼ,ǻ
+			for (int i = 0; flock(fd, LOCK_EX | LOCK_NB) != 0; i++)
+			{
+				if ((errno != EWOULDBLOCK && errno != EINTR) || i >= SHARED_OBJECT_WAIT_MS)
+				{
+					close(fd);
+					return NULL;
+				}
+				usleep(1000);
+			}
+
+			void* addr = MAP_FAILED;
+			struct stat st;
+			if (fstat(fd, &st) == 0 && ((size_t)st.st_size >= total_size || ftruncate(fd, total_size) == 0))
+			{
+				addr = mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			}
+			if (addr != MAP_FAILED)
+			{
+				//½ĹڴȫΪ0;߳ʼһ˳ʱ״̬ҲREADY,³ʼ
+				SharedObjectHeader* header = (SharedObjectHeader*)addr;
+				if (header->init_state.load(std::memory_order_acquire) != SHARED_OBJECT_READY)
+				{
+					init(header + 1, context);
+					header->init_state.store(SHARED_OBJECT_READY, std::memory_order_release);
+				}
+			}
+			flock(fd, LOCK_UN);
+			close(fd);
+			return addr != MAP_FAILED ? (SharedObjectHeader*)addr + 1 : NULL;
+		}
+
+		//ֻӳ,ڴ汣
+		void CloseSharedObject(void* object, size_t object_size)
+		{
+			SharedObjectHeader* header = (SharedObjectHeader*)object - 1;
+			munmap(header, sizeof(SharedObjectHeader) + object_size);
+		}
+
+		void InitPosixMutex(pthread_mutex_t* mutex, bool shared, bool recursive)
+		{
+			pthread_mutexattr_t attr;
+			pthread_mutexattr_init(&attr);
+			if (recursive)
+			{
+				pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+			}
+			if (shared)
+			{
+				pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+				pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+			}
+			pthread_mutex_init(mutex, &attr);
+			pthread_mutexattr_destroy(&attr);
+		}
+
+		void InitPosixCondition(pthread_cond_t* cond, bool shared)
+		{
+			pthread_condattr_t attr;
+			pthread_condattr_init(&attr);
+			pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);//ʱȴϵͳʱӰ
+			if (shared)
+			{
+				pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+			}
+			pthread_cond_init(cond, &attr);
+			pthread_condattr_destroy(&attr);
+		}
+
+		bool LockPosixMutex(pthread_mutex_t* mutex)
+		{
+			int ret = pthread_mutex_lock(mutex);
+			if (ret == EOWNERDEAD)
+			{
+				//ĽѾ˳,ָ֮ʹ
+				pthread_mutex_consistent(mutex);
+				ret = 0;
+			}
+			return ret == 0;
+		}
+
+		void GetMonotonicDeadline(int nMillonSecond, struct timespec* deadline)
+		{
+			clock_gettime(CLOCK_MONOTONIC, deadline);
+			deadline->tv_sec += nMillonSecond / 1000;
+			deadline->tv_nsec += (long)(nMillonSecond % 1000) * 1000000L;
+			if (deadline->tv_nsec >= 1000000000L)
+			{
+				deadline->tv_sec += 1;
+				deadline->tv_nsec -= 1000000000L;
+			}
+		}
+
+		//ȴ*valueΪ0,nMillonSecond<=0ʱһֱȴ.ǰѾ
+		bool WaitPosixCondition(pthread_cond_t* cond, pthread_mutex_t* mutex, int nMillonSecond, const volatile long* value)
+		{
+			struct timespec deadline;
+			if (nMillonSecond > 0)
+			{
+				GetMonotonicDeadline(nMillonSecond, &deadline);
+			}
+			while (*value == 0)
+			{
+				int ret = (nMillonSecond > 0) ? pthread_cond_timedwait(cond, mutex, &deadline) : pthread_cond_wait(cond, mutex);
+				if (ret == EOWNERDEAD)
+				{
+					pthread_mutex_consistent(mutex);
+				}
+				else if (ret == ETIMEDOUT)
+				{
+					break;
+				}
+			}
+			return *value != 0;
+		}
 	}
 
-	int TimerTask::GetVectorIndex(void)
+	struct CommonMutex::PosixMutex
 	{
-		return vect_index_;
-	}
+		pthread_mutex_t mutex;
+	};
 
-	void TimerTask::HandleTask()
+	CommonMutex::CommonMutex(std::string mutex_name, MutexMode mutex_mode)
+		: mutex_mode_(mutex_mode), lock_state_(0)
 	{
-		
-		if (timer_type_ != CIRCLE)
+		mutex_name_ = mutex_name;
+#ifdef MULTIPROCESS
+		if (mutex_name_ != "")
 		{
-			vect_index_ = -1;
+			mutex_mode_ = MUTEX_DEFAULT;
+			mutex_ = (PosixMutex*)OpenSharedObject(SharedObjectPath("mutex", mutex_name_), sizeof(PosixMutex),
+				[](void* object, void*) { InitPosixMutex(&((PosixMutex*)object)->mutex, true, true); }, NULL);
+			return;
 		}
+#endif
+		mutex_ = new PosixMutex();
+		InitPosixMutex(&mutex_->mutex, false, true);
+	}
 
-		if (timer_notify_ != NULL)
+	CommonMutex::~CommonMutex()
+	{
+		if (mutex_ == NULL)
 		{
-			timer_notify_->OnTimerNotify();
+			return;
+		}
+#ifdef MULTIPROCESS
+		if (mutex_name_ != "")
+		{
+			CloseSharedObject(mutex_, sizeof(PosixMutex));
+			return;
 		}
+#endif
+		pthread_mutex_destroy(&mutex_->mutex);
+		delete mutex_;
 	}
 
-	TimerManager::TimerManager()
+	bool CommonMutex::LockObject(void)
 	{
-		timer_wheel_.resize(WHEEL_SIZE1 + 4 * WHEEL_SIZE2);
-		current_pos_ = 0;
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			return AdaptiveLock(-1);
+		}
+		if (NULL == mutex_)
+		{
+			return FALSE;
+		}
+		return LockPosixMutex(&mutex_->mutex);
 	}
 
-	TimerManager::~TimerManager()
+	bool CommonMutex::TryLockObject(void)
 	{
-
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			return AdaptiveLock(0);
+		}
+		if (NULL == mutex_)
+		{
+			return FALSE;
+		}
+		int ret = pthread_mutex_trylock(&mutex_->mutex);
+		if (ret == EOWNERDEAD)
+		{
+			pthread_mutex_consistent(&mutex_->mutex);
+			ret = 0;
+		}
+		return ret == 0;
 	}
 
-	void TimerManager::AddTimer(TimerTask* timer_task)
+	bool CommonMutex::TimedLockObject(int nMillonSecond)
 	{
-		unsigned long long interval_time = timer_task->GetIntervalTime();
-		unsigned long long tmp_interval = interval_time /WHEEL_SCALE;
-		int vect_index = 0;
-
-		if (tmp_interval < WHEEL_SIZE1)
+		if (nMillonSecond < 0)
 		{
-			vect_index = (tmp_interval + current_pos_) % WHEEL_SIZE1;
+			nMillonSecond = 0;
 		}
-		else if (tmp_interval < ((unsigned)1 << (WHEEL_BIT1 + WHEEL_BIT2)))
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
 		{
-			vect_index = INDEX(tmp_interval + current_pos_, 0) % WHEEL_SIZE2 + OFFSET(0);
+			return AdaptiveLock(nMillonSecond);
 		}
-		else if (tmp_interval < ((unsigned)1 << (WHEEL_BIT1 + 2 * WHEEL_BIT2)))
+		if (NULL == mutex_)
 		{
-			vect_index = INDEX(tmp_interval + current_pos_, 1) % WHEEL_SIZE2 + OFFSET(1);
+			return FALSE;
 		}
-		else if (tmp_interval < ((unsigned)1 << (WHEEL_BIT1 + 3 * WHEEL_BIT2)))
+		struct timespec deadline;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+		GetMonotonicDeadline(nMillonSecond, &deadline);
+		int ret = pthread_mutex_clocklock(&mutex_->mutex, CLOCK_MONOTONIC, &deadline);
+#else
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += nMillonSecond / 1000;
+		deadline.tv_nsec += (long)(nMillonSecond % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
 		{
-			vect_index = INDEX(tmp_interval + current_pos_, 2) % WHEEL_SIZE2 + OFFSET(2);
+			deadline.tv_sec += 1;
+			deadline.tv_nsec -= 1000000000L;
 		}
-		else if (tmp_interval < ((unsigned long long)1 << (WHEEL_BIT1 + 4 * WHEEL_BIT2)))
+		int ret = pthread_mutex_timedlock(&mutex_->mutex, &deadline);
+#endif
+		if (ret == EOWNERDEAD)
 		{
-			vect_index = INDEX(tmp_interval + current_pos_, 3) % WHEEL_SIZE2 + OFFSET(3);
+			pthread_mutex_consistent(&mutex_->mutex);
+			ret = 0;
 		}
-
-		timer_task->SetVectorIndex(vect_index);
-
-		TIMER_LIST& tlist = timer_wheel_[timer_task->GetVectorIndex()];
-		tlist.push_back(timer_task);
-		timer_task->itr_ = tlist.end();
-		--timer_task->itr_;
+		return ret == 0;
 	}
 
-	void TimerManager::RemoveTimer(TimerTask* timer_task)
+	bool CommonMutex::UnlockObject(void)
 	{
-		TIMER_LIST& tlist = timer_wheel_[timer_task->GetVectorIndex()];
-		tlist.erase(timer_task->itr_);
+		if (mutex_mode_ == MUTEX_ADAPTIVE)
+		{
+			AdaptiveUnlock();
+			return TRUE;
+		}
+		if (NULL == mutex_)
+		{
+			return FALSE;
+		}
+		return pthread_mutex_unlock(&mutex_->mutex) == 0;
 	}
 
-	void TimerManager::DetectTimers()
+	struct CommonEvent::PosixEvent
 	{
-		if (current_pos_ < 0xffffffffUL)
-		{
-			int index = (current_pos_) % WHEEL_SIZE1;
-			if (!index &&
-				!Cascade(OFFSET(0), INDEX(current_pos_ , 0)) &&
-				!Cascade(OFFSET(1), INDEX(current_pos_, 1)) &&
-				!Cascade(OFFSET(2), INDEX(current_pos_, 2)))
-			{
-				Cascade(OFFSET(3), INDEX(current_pos_ , 3));
-			}
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		volatile long signaled;
+	};
 
-			Sleep(WHEEL_SCALE);
-
-			TIMER_LIST& tlist = timer_wheel_[index];
-			TIMER_LIST temp;
-			temp.splice(temp.end(), tlist);
-			for (TIMER_LIST::iterator itr = temp.begin(); itr != temp.end(); ++itr)
-			{
-				(*itr)->HandleTask();
-				if ((*itr)->GetVectorIndex() != -1)
-				{
-					AddTimer(*itr);
-				}
-			}
-			current_pos_ += 1;
+	CommonEvent::CommonEvent(std::string event_name)
+	{
+		event_name_ = event_name;
+		SharedObjectInit init = [](void* object, void* context) {
+			bool shared = ((CommonEvent*)context)->event_name_ != "";
+			PosixEvent* event = (PosixEvent*)object;
+			InitPosixMutex(&event->mutex, shared, false);
+			InitPosixCondition(&event->cond, shared);
+			event->signaled = 0;
+		};
+		if (event_name_ != "")
+		{
+			event_ = (PosixEvent*)OpenSharedObject(SharedObjectPath("event", event_name_), sizeof(PosixEvent), init, this);
 		}
 		else
 		{
-			current_pos_ = 0;
+			event_ = new PosixEvent();
+			init(event_, this);
 		}
 	}
 
-	int TimerManager::Cascade(int offset, int index)
+	CommonEvent::~CommonEvent()
 	{
-		TIMER_LIST& tlist = timer_wheel_[offset + index];
-		TIMER_LIST temp;
-		temp.splice(temp.end(), tlist);
-
-		for (TIMER_LIST::iterator itr = temp.begin(); itr != temp.end(); ++itr)
+		if (event_ == NULL)
 		{
-			AddTimer(*itr);
+			return;
 		}
-
-		return index;
+		if (event_name_ != "")
+		{
+			CloseSharedObject(event_, sizeof(PosixEvent));
+			return;
+		}
+		pthread_cond_destroy(&event_->cond);
+		pthread_mutex_destroy(&event_->mutex);
+		delete event_;
 	}
 
-	TimerThread::TimerThread() 
+	bool CommonEvent::WaitForEventSignaled(int nMillonSecond)
 	{
-		exit_flag_ = FALSE;
-		task_list_.clear();
+		if (NULL == event_ || !LockPosixMutex(&event_->mutex))
+		{
+			return FALSE;
+		}
+		bool ret = WaitPosixCondition(&event_->cond, &event_->mutex, nMillonSecond, &event_->signaled);
+		pthread_mutex_unlock(&event_->mutex);
+		return ret;
 	}
 
-	TimerThread::~TimerThread()
+	bool CommonEvent::SetEvent()
 	{
-		task_list_.clear();
+		if (NULL == event_ || !LockPosixMutex(&event_->mutex))
+		{
+			return FALSE;
+		}
+		event_->signaled = 1;
+		pthread_cond_broadcast(&event_->cond);
+		pthread_mutex_unlock(&event_->mutex);
+		return TRUE;
 	}
 
-	void TimerThread::ThreadWorkFunc(THREAD_PARAMETERS* work_para)
+	bool CommonEvent::ResetEvent()
 	{
-		while (!exit_flag_)
+		if (NULL == event_ || !LockPosixMutex(&event_->mutex))
 		{
-			if (task_list_.size() == 0)
-			{
-				comm_event_.ResetEvent();
-				comm_event_.WaitForEventSignaled();
-			}
-			timer_manager_.DetectTimers();
+			return FALSE;
 		}
+		event_->signaled = 0;
+		pthread_mutex_unlock(&event_->mutex);
+		return TRUE;
 	}
 
-	TimerTask* TimerThread::SetATimer(TimerNotify* timer_notify, unsigned interval_time, TimerType timeType)
+	struct CommonSemaphore::PosixSemaphore
 	{
-		if (interval_time >= 0xFFFFFFFFUL)
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		volatile long count;
+		long max_count;
+	};
+
+	CommonSemaphore::CommonSemaphore(LONG init_sem_count, LONG max_sem_count, std::string semaphore_name)
+	{
+		if (init_sem_count < 0)
+			init_sem_count_ = 1;
+		else
+			init_sem_count_ = init_sem_count;
+
+		if (max_sem_count <= 0)
+			max_sem_count_ = 1;
+		else
+			max_sem_count_ = max_sem_count;
+
+		semaphore_name_ = semaphore_name;
+		SharedObjectInit init = [](void* object, void* context) {
+			CommonSemaphore* owner = (CommonSemaphore*)context;
+			bool shared = owner->semaphore_name_ != "";
+			PosixSemaphore* semaphore = (PosixSemaphore*)object;
+			InitPosixMutex(&semaphore->mutex, shared, false);
+			InitPosixCondition(&semaphore->cond, shared);
+			semaphore->count = (owner->init_sem_count_ < owner->max_sem_count_) ? owner->init_sem_count_ : owner->max_sem_count_;
+			semaphore->max_count = owner->max_sem_count_;
+		};
+		if (semaphore_name_ != "")
 		{
-			return NULL;
+			semaphore_ = (PosixSemaphore*)OpenSharedObject(SharedObjectPath("semaphore", semaphore_name_), sizeof(PosixSemaphore), init, this);
 		}
-		TimerTask* timer_task = new TimerTask();
-		if (timer_task == NULL)
+		else
 		{
-			return NULL;
+			semaphore_ = new PosixSemaphore();
+			init(semaphore_, this);
 		}
-		timer_task->SetTimerTask(timer_notify, interval_time, timeType);
-		timer_manager_.AddTimer(timer_task);
-		task_list_.push_back(timer_task);
-		comm_event_.SetEvent();
-		return timer_task;
 	}
 
-	void TimerThread::StopATimer(TimerTask* timer_task)
+	CommonSemaphore::~CommonSemaphore()
 	{
-		timer_manager_.RemoveTimer(timer_task);
-		task_list_.remove(timer_task);
-
-		if (timer_task != NULL)
+		if (semaphore_ == NULL)
 		{
-			delete timer_task;
+			return;
+		}
+		if (semaphore_name_ != "")
+		{
+			CloseSharedObject(semaphore_, sizeof(PosixSemaphore));
+			return;
 		}
+		pthread_cond_destroy(&semaphore_->cond);
+		pthread_mutex_destroy(&semaphore_->mutex);
+		delete semaphore_;
 	}
 
-	BOOL TimerThread::StartTimerThread()
+	bool CommonSemaphore::WaitForSemSignaled(int nMillonSecond)
 	{
-		return CreateThread();
-	}
-	
-	void TimerThread::StopTimerThread()
+		if (NULL == semaphore_ || !LockPosixMutex(&semaphore_->mutex))
+		{
+			return FALSE;
+		}
+		bool ret = WaitPosixCondition(&semaphore_->cond, &semaphore_->mutex, nMillonSecond, &semaphore_->count);
+		if (ret)
+		{
+			semaphore_->count--;
+		}
+		pthread_mutex_unlock(&semaphore_->mutex);
+		return ret;
+	}
+
+	bool CommonSemaphore::ReleaseSemObject()
+	{
+		if (NULL == semaphore_ || !LockPosixMutex(&semaphore_->mutex))
+		{
+			return FALSE;
+		}
+		bool ret = false;
+		if (semaphore_->count < semaphore_->max_count)
+		{
+			semaphore_->count++;
+			pthread_cond_signal(&semaphore_->cond);
+			ret = true;
+		}
+		pthread_mutex_unlock(&semaphore_->mutex);
+		return ret;
+	}
+
+	CommonRWLock::CommonRWLock(bool prefer_writer)
+		: prefer_writer_(prefer_writer)
+	{
+		pthread_rwlockattr_t attr;
+		pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__)
+		//glibcĬ϶
+		pthread_rwlockattr_setkind_np(&attr, prefer_writer_ ?
+			PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP : PTHREAD_RWLOCK_PREFER_READER_NP);
+#endif
+		pthread_rwlock_init(&rw_lock_, &attr);
+		pthread_rwlockattr_destroy(&attr);
+	}
+
+	CommonRWLock::~CommonRWLock()
+	{
+		pthread_rwlock_destroy(&rw_lock_);
+	}
+
+	bool CommonRWLock::LockShared(void)
+	{
+		return pthread_rwlock_rdlock(&rw_lock_) == 0;
+	}
+
+	bool CommonRWLock::TryLockShared(void)
+	{
+		return pthread_rwlock_tryrdlock(&rw_lock_) == 0;
+	}
+
+	bool CommonRWLock::UnlockShared(void)
+	{
+		return pthread_rwlock_unlock(&rw_lock_) == 0;
+	}
+
+	bool CommonRWLock::LockExclusive(void)
+	{
+		return pthread_rwlock_wrlock(&rw_lock_) == 0;
+	}
+
+	bool CommonRWLock::TryLockExclusive(void)
+	{
+		return pthread_rwlock_trywrlock(&rw_lock_) == 0;
+	}
+
+	bool CommonRWLock::UnlockExclusive(void)
+	{
+		return pthread_rwlock_unlock(&rw_lock_) == 0;
+	}
+#endif // _WIN32
+
+	namespace {
+		//ȴʱCPUĲó̵ִ߳Դ
+		inline void CpuRelax()
+		{
+#if defined(_MSC_VER)
+			YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+			__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+			__asm__ __volatile__("yield");
+#endif
+		}
+
+		//*addressexpectedʱ,ֱѻʱ(nMillonSecond<0ʱʱ)
+		void ParkOnAddress(std::atomic<int>* address, int expected, int nMillonSecond)
+		{
+#if defined(_WIN32)
+			WaitOnAddress(address, &expected, sizeof(int), nMillonSecond < 0 ? INFINITE : (DWORD)nMillonSecond);
+#elif defined(__linux__)
+			struct timespec timeout;
+			struct timespec* timeout_ptr = NULL;
+			if (nMillonSecond >= 0)
+			{
+				timeout.tv_sec = nMillonSecond / 1000;
+				timeout.tv_nsec = (long)(nMillonSecond % 1000) * 1000000L;
+				timeout_ptr = &timeout;
+			}
+			syscall(SYS_futex, (int*)address, FUTEX_WAIT_PRIVATE, expected, timeout_ptr, NULL, 0);
+#else
+			if (address->load(std::memory_order_relaxed) == expected)
+			{
+				Sleep(nMillonSecond < 0 || nMillonSecond > 1 ? 1 : nMillonSecond);
+			}
+#endif
+		}
+
+		void WakeOneOnAddress(std::atomic<int>* address)
+		{
+#if defined(_WIN32)
+			WakeByAddressSingle(address);
+#elif defined(__linux__)
+			syscall(SYS_futex, (int*)address, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+			(void)address;
+#endif
+		}
+
+		const int ADAPTIVE_SPIN_LIMIT = 4000;//pauseָ
+		const int ADAPTIVE_MAX_BACKOFF = 256;//γִ֮еpauseָ
+	}
+
+	bool CommonMutex::AdaptiveLock(int nMillonSecond)
+	{
+		int state = 0;
+		if (lock_state_.compare_exchange_strong(state, 1, std::memory_order_acquire))
+		{
+			return TRUE;
+		}
+		if (nMillonSecond == 0)
+		{
+			return FALSE;
+		}
+
+		/*׶:ÿʧܺȴpauseָ,ٶڻе*/
+		int backoff = 1;
+		for (int spin = 0; spin < ADAPTIVE_SPIN_LIMIT; spin += backoff)
+		{
+			for (int i = 0; i < backoff; i++)
+			{
+				CpuRelax();
+			}
+			if (backoff < ADAPTIVE_MAX_BACKOFF)
+			{
+				backoff <<= 1;
+			}
+			state = lock_state_.load(std::memory_order_relaxed);
+			if (state == 0 && lock_state_.compare_exchange_weak(state, 1, std::memory_order_acquire))
+			{
+				return TRUE;
+			}
+		}
+
+		/*׶:״̬Ϊ2(еȴ),߳̿2ʱ*/
+		SystemTime system_time;
+		unsigned long long deadline = (nMillonSecond > 0) ? system_time.GetCurrentMilliseconds() + nMillonSecond : 0;
+		state = lock_state_.exchange(2, std::memory_order_acquire);
+		while (state != 0)
+		{
+			int wait_time = -1;
+			if (nMillonSecond > 0)
+			{
+				unsigned long long now = system_time.GetCurrentMilliseconds();
+				if (now >= deadline)
+				{
+					return FALSE;
+				}
+				wait_time = (int)(deadline - now);
+			}
+			ParkOnAddress(&lock_state_, 2, wait_time);
+			state = lock_state_.exchange(2, std::memory_order_acquire);
+		}
+		return TRUE;
+	}
+
+	void CommonMutex::AdaptiveUnlock(void)
+	{
+		if (lock_state_.exchange(0, std::memory_order_release) == 2)
+		{
+			WakeOneOnAddress(&lock_state_);
+		}
+	}
+
+	std::atomic<int> FixedSizePool::pool_count_(0);
+	thread_local FixedSizePool::ThreadCache FixedSizePool::thread_caches_[FixedSizePool::MAX_POOLS];
+
+	FixedSizePool::FixedSizePool(size_t block_size)
+		: slab_count_(0), mutex_("", MUTEX_ADAPTIVE)
+	{
+		block_size_ = (block_size + 15) & ~(size_t)15;
+		stride_ = sizeof(BlockHeader) + block_size_;
+		pool_id_ = pool_count_.fetch_add(1, std::memory_order_relaxed);
+		slabs_ = new std::atomic<char*>[MAX_SLABS];
+		for (int i = 0; i < MAX_SLABS; i++)
+		{
+			slabs_[i].store(NULL, std::memory_order_relaxed);
+		}
+	}
+
+	FixedSizePool::~FixedSizePool()
+	{
+		for (unsigned i = 0; i < slab_count_; i++)
+		{
+			delete[] slabs_[i].load(std::memory_order_relaxed);
+		}
+		delete[] slabs_;
+	}
+
+	FixedSizePool::ThreadCache::~ThreadCache()
+	{
+		if (pool != NULL && count > 0)
+		{
+			pool->ReleaseBatch(items, count);
+		}
+	}
+
+	void* FixedSizePool::Allocate()
+	{
+		unsigned index = 0;
+		ThreadCache* cache = GetThreadCache();
+		if (cache == NULL)
+		{
+			if (FetchBatch(&index, 1) == 0)
+			{
+				return NULL;
+			}
+		}
+		else
+		{
+			if (cache->count == 0)
+			{
+				cache->count = FetchBatch(cache->items, CACHE_SIZE / 2);
+				if (cache->count == 0)
+				{
+					return NULL;
+				}
+			}
+			index = cache->items[--cache->count];
+		}
+		return (char*)GetHeader(index) + sizeof(BlockHeader);
+	}
+
+	void FixedSizePool::Deallocate(void* block)
+	{
+		if (block == NULL)
+		{
+			return;
+		}
+		BlockHeader* header = (BlockHeader*)((char*)block - sizeof(BlockHeader));
+		/*1ʹɾʧЧ,0Ч*/
+		unsigned generation = header->generation.load(std::memory_order_relaxed) + 1;
+		header->generation.store(generation == 0 ? 1 : generation, std::memory_order_release);
+
+		ThreadCache* cache = GetThreadCache();
+		if (cache == NULL)
+		{
+			ReleaseBatch(&header->index, 1);
+			return;
+		}
+		if (cache->count == CACHE_SIZE)
+		{
+			/*,һ뻹ȫֿ*/
+			ReleaseBatch(cache->items + CACHE_SIZE / 2, CACHE_SIZE / 2);
+			cache->count = CACHE_SIZE / 2;
+		}
+		cache->items[cache->count++] = header->index;
+	}
+
+	unsigned long long FixedSizePool::GetHandle(void* block)
+	{
+		BlockHeader* header = (BlockHeader*)((char*)block - sizeof(BlockHeader));
+		return ((unsigned long long)header->generation.load(std::memory_order_acquire) << 32) | header->index;
+	}
+
+	void* FixedSizePool::GetBlock(unsigned long long handle)
+	{
+		unsigned index = (unsigned)handle;
+		if ((index >> SLAB_SHIFT) >= MAX_SLABS ||
+			slabs_[index >> SLAB_SHIFT].load(std::memory_order_acquire) == NULL)
+		{
+			return NULL;
+		}
+		BlockHeader* header = GetHeader(index);
+		if (header->generation.load(std::memory_order_acquire) != (unsigned)(handle >> 32))
+		{
+			return NULL;
+		}
+		return (char*)header + sizeof(BlockHeader);
+	}
+
+	size_t FixedSizePool::GetBlockSize() const
+	{
+		return block_size_;
+	}
+
+	FixedSizePool::BlockHeader* FixedSizePool::GetHeader(unsigned index)
+	{
+		char* slab = slabs_[index >> SLAB_SHIFT].load(std::memory_order_acquire);
+		return (BlockHeader*)(slab + (index & (SLAB_BLOCKS - 1)) * stride_);
+	}
+
+	int FixedSizePool::FetchBatch(unsigned* items, int count)
+	{
+		MutexGuard guard(mutex_);
+		if (free_list_.empty())
+		{
+			if (slab_count_ >= MAX_SLABS)
+			{
+				return 0;
+			}
+			/*гһµslab,пȫֿ*/
+			char* slab = new char[stride_ * SLAB_BLOCKS];
+			unsigned base = slab_count_ << SLAB_SHIFT;
+			for (unsigned i = 0; i < SLAB_BLOCKS; i++)
+			{
+				BlockHeader* header = new (slab + i * stride_) BlockHeader;
+				header->index = base + i;
+				header->generation.store(1, std::memory_order_relaxed);
+				header->reserved = 0;
+			}
+			slabs_[slab_count_].store(slab, std::memory_order_release);
+			slab_count_++;
+			for (unsigned i = SLAB_BLOCKS; i > 0; i--)
+			{
+				free_list_.push_back(base + i - 1);
+			}
+		}
+
+		int fetched = 0;
+		while (fetched < count && !free_list_.empty())
+		{
+			items[fetched++] = free_list_.back();
+			free_list_.pop_back();
+		}
+		return fetched;
+	}
+
+	void FixedSizePool::ReleaseBatch(const unsigned* items, int count)
+	{
+		MutexGuard guard(mutex_);
+		free_list_.insert(free_list_.end(), items, items + count);
+	}
+
+	FixedSizePool::ThreadCache* FixedSizePool::GetThreadCache()
+	{
+		if (pool_id_ >= MAX_POOLS)
+		{
+			return NULL;
+		}
+		ThreadCache* cache = &thread_caches_[pool_id_];
+		cache->pool = this;
+		return cache;
+	}
+
+	FixedSizePool* FixedSizePool::GetSmallPool(size_t size)
+	{
+		/*ڽ˳֮ǰһֱЧ,߳˳ʱ黹治Ѿĳ*/
+		static FixedSizePool* small_pools[4] = {
+			new FixedSizePool(32), new FixedSizePool(64), new FixedSizePool(128), new FixedSizePool(256) };
+		for (int i = 0; i < 4; i++)
+		{
+			if (size <= small_pools[i]->GetBlockSize())
+			{
+				return small_pools[i];
+			}
+		}
+		return NULL;
+	}
+
+	void* FixedSizePool::AllocateSmall(size_t size)
+	{
+		FixedSizePool* pool = GetSmallPool(size);
+		if (pool == NULL)
+		{
+			return ::operator new(size);
+		}
+		void* block = pool->Allocate();
+		if (block == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		return block;
+	}
+
+	void FixedSizePool::DeallocateSmall(void* block, size_t size)
+	{
+		FixedSizePool* pool = GetSmallPool(size);
+		if (pool == NULL)
+		{
+			::operator delete(block);
+			return;
+		}
+		pool->Deallocate(block);
+	}
+
+	SystemTime::SystemTime(void)
+	{
+	}
+
+	SystemTime::~SystemTime(void)
+	{
+	}
+
+	unsigned long long SystemTime::GetCurrentMilliseconds()
+	{
+		return MonotonicClock::NowMs();
+	}
+
+	unsigned long long SystemTime::GetCurrentNanoseconds()
+	{
+		return MonotonicClock::NowNs();
+	}
+
+	TimerTask::TimerTask()
+	{
+		owner_ = NULL;
+		interval_time_ = 0;
+		vect_index_ = -1;
+		registry_index_ = -1;
+		dispatch_state_ = 0;
+		timer_notify_ = NULL;
+		timer_type_ = CIRCLE;
+	}
+
+	TimerTask::~TimerTask()
+	{
+		if (timer_notify_ != NULL)
+		{
+			delete timer_notify_;
+		}
+	}
+
+	void TimerTask::SetTimerTask(TimerNotify* timer_notify, unsigned interval, TimerType timer_type)
+	{
+		interval_time_ = interval;
+		timer_notify_ = timer_notify;
+		timer_type_ = timer_type;
+	}
+
+	void TimerTask::SetTimerCallback(TimerCallback&& timer_callback)
+	{
+		timer_callback_ = std::move(timer_callback);
+	}
+
+	unsigned TimerTask::GetIntervalTime()
+	{
+		return interval_time_;
+	}
+
+	void TimerTask::SetIntervalTime(unsigned interval)
+	{
+		interval_time_ = interval;
+	}
+	void TimerTask::SetVectorIndex(int vect_index)
+	{
+		vect_index_ = vect_index;
+	}
+
+	int TimerTask::GetVectorIndex(void)
+	{
+		return vect_index_;
+	}
+
+	void TimerTask::SetRegistryIndex(int registry_index)
+	{
+		registry_index_ = registry_index;
+	}
+
+	int TimerTask::GetRegistryIndex(void)
+	{
+		return registry_index_;
+	}
+
+	void TimerTask::AddDispatchRef(void)
+	{
+		dispatch_state_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool TimerTask::ReleaseDispatchRef(void)
+	{
+		return dispatch_state_.fetch_sub(1, std::memory_order_acq_rel) == (DISPATCH_RELEASED | 1u);
+	}
+
+	bool TimerTask::ReleaseTask(void)
+	{
+		return (dispatch_state_.fetch_or(DISPATCH_RELEASED, std::memory_order_acq_rel) & DISPATCH_COUNT_MASK) == 0;
+	}
+
+	bool TimerTask::IsDispatching(void)
+	{
+		return (dispatch_state_.load(std::memory_order_relaxed) & DISPATCH_COUNT_MASK) != 0;
+	}
+
+	void TimerTask::SetOwner(TimerThread* owner)
+	{
+		owner_ = owner;
+	}
+
+	TimerThread* TimerTask::GetOwner(void)
+	{
+		return owner_;
+	}
+
+	void TimerTask::SetExpireTick(unsigned long long expire_tick)
+	{
+		expire_tick_ = expire_tick;
+	}
+
+	unsigned long long TimerTask::GetExpireTick(void)
+	{
+		return expire_tick_;
+	}
+
+	TimerType TimerTask::GetTimerType(void)
+	{
+		return timer_type_;
+	}
+
+	TimerHandle TimerTask::GetHandle(void)
+	{
+		return GetPool().GetHandle(this);
+	}
+
+	void TimerTask::InitLazyState(void)
+	{
+		lazy_state_.store(GetHandle() & 0xFFFFFFFF00000000ULL, std::memory_order_release);
+	}
+
+	unsigned long long TimerTask::GetLazyState(void)
+	{
+		return lazy_state_.load(std::memory_order_acquire);
+	}
+
+	bool TimerTask::CompareExchangeLazyState(unsigned long long& expected, unsigned long long desired)
+	{
+		return lazy_state_.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+	}
+
+	TimerTask* TimerTask::FromHandle(TimerHandle handle)
+	{
+		return (TimerTask*)GetPool().GetBlock(handle);
+	}
+
+	void* TimerTask::operator new(size_t size)
+	{
+		//صĿСsizeof(TimerTask),ɿڳеλ,಻ܴط
+		if (size > GetPool().GetBlockSize())
+		{
+			throw std::bad_alloc();
+		}
+		void* block = GetPool().Allocate();
+		if (block == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		return block;
+	}
+
+	void TimerTask::operator delete(void* block)
+	{
+		GetPool().Deallocate(block);
+	}
+
+	FixedSizePool& TimerTask::GetPool()
+	{
+		static FixedSizePool* task_pool = new FixedSizePool(sizeof(TimerTask));
+		return *task_pool;
+	}
+
+	void TimerTask::HandleTask(TimerDispatcher* dispatcher)
+	{
+		
+		if (timer_type_ != CIRCLE)
+		{
+			vect_index_ = -1;
+		}
+
+		if (dispatcher != NULL)
+		{
+			dispatcher->Dispatch(this);
+			return;
+		}
+		RunCallback();
+	}
+
+	void TimerTask::RunCallback()
+	{
+		TIMER_STAT(unsigned long long start_ns = TimerStats::BeginCallback());
+		if (timer_notify_ != NULL)
+		{
+			timer_notify_->OnTimerNotify();
+		}
+		else if (timer_callback_)
+		{
+			timer_callback_();
+		}
+		TIMER_STAT(TimerStats::EndCallback(start_ns));
+	}
+
+	TimerManager::TimerManager(unsigned tick_ms)
+	{
+		tick_ms_ = (tick_ms > 0) ? tick_ms : 1;
+		wheel_tick_ms_ = tick_ms_;
+		use_heap_ = false;
+		timer_wheel_ = new TimerTaskWheel();
+		timer_heap_ = NULL;
+		start_time_ = system_time_.GetCurrentMilliseconds();
+		tickless_ = true;
+		dispatcher_ = NULL;
+	}
+
+	TimerManager::~TimerManager()
+	{
+		delete timer_wheel_;
+		delete timer_heap_;
+	}
+
+	TimerQueuePolicy TimerManager::SelectQueue(TimerQueuePolicy policy, unsigned expected_timers)
+	{
+		if (policy != TIMER_QUEUE_AUTO)
+		{
+			return policy;
+		}
+		return (expected_timers > 0 && expected_timers <= HEAP_MAX_TIMERS) ? TIMER_QUEUE_HEAP : TIMER_QUEUE_WHEEL;
+	}
+
+	bool TimerManager::SetQueuePolicy(TimerQueuePolicy policy, unsigned expected_timers)
+	{
+		if (GetTimerCount() > 0)
+		{
+			return false;
+		}
+		/*ֻѡеĶ,ʹöʱռʱֵĲλͼ.
+		*½Ķдӵ0̶ȿʼ,նƽʱֱǰ̶*/
+		use_heap_ = SelectQueue(policy, expected_timers) == TIMER_QUEUE_HEAP;
+		tick_ms_ = use_heap_ ? 1 : wheel_tick_ms_;
+		if (use_heap_ && timer_heap_ == NULL)
+		{
+			delete timer_wheel_;
+			timer_wheel_ = NULL;
+			timer_heap_ = new TimerHeap();
+		}
+		else if (!use_heap_ && timer_wheel_ == NULL)
+		{
+			delete timer_heap_;
+			timer_heap_ = NULL;
+			timer_wheel_ = new TimerTaskWheel();
+		}
+		return true;
+	}
+
+	bool TimerManager::IsHeapQueue(void)
+	{
+		return use_heap_;
+	}
+
+	unsigned TimerManager::GetTimerCount(void)
+	{
+		return (unsigned)(use_heap_ ? timer_heap_->GetCount() : timer_wheel_->GetCount());
+	}
+
+	bool TimerManager::IsQueued(TimerTask* timer_task)
+	{
+		return use_heap_ ? TimerHeap::IsLinked(timer_task) : TimerTaskWheel::IsLinked(timer_task);
+	}
+
+	unsigned long long TimerManager::GetQueueTick(void)
+	{
+		return use_heap_ ? timer_heap_->GetCurrentTick() : timer_wheel_->GetCurrentTick();
+	}
+
+	unsigned TimerManager::GetTickInterval(void)
+	{
+		return tick_ms_;
+	}
+
+	void TimerManager::SetTicklessMode(bool tickless)
+	{
+		tickless_ = tickless;
+	}
+
+	void TimerManager::SetDispatcher(TimerDispatcher* dispatcher)
+	{
+		dispatcher_ = dispatcher;
+	}
+
+	unsigned long long TimerManager::GetCurrentTick(void)
+	{
+		return (system_time_.GetCurrentMilliseconds() - start_time_) / tick_ms_;
+	}
+
+	unsigned long long TimerManager::IntervalToTicks(unsigned interval)
+	{
+		unsigned long long ticks = ((unsigned long long)interval + tick_ms_ - 1) / tick_ms_;
+		return (ticks > 0) ? ticks : 1;
+	}
+
+	void TimerManager::AddTimer(TimerTask* timer_task)
+	{
+		TIMER_STAT(TimerStats::RecordArm());
+		timer_task->SetExpireTick(CalcExpireTick(timer_task->GetIntervalTime()));
+		InsertTimer(timer_task);
+		PublishExpireTick(timer_task, false);
+	}
+
+	void TimerManager::RescheduleTimer(TimerTask* timer_task, unsigned interval)
+	{
+		TIMER_STAT(TimerStats::RecordReschedule());
+		if (use_heap_)
+		{
+			timer_heap_->Remove(timer_task);
+		}
+		else
+		{
+			timer_wheel_->Remove(timer_task);
+		}
+		timer_task->SetIntervalTime(interval);
+		timer_task->SetExpireTick(CalcExpireTick(interval));
+		InsertTimer(timer_task);
+		PublishExpireTick(timer_task, false);
+	}
+
+	bool TimerManager::PostponeTimer(TimerTask* timer_task, unsigned generation, unsigned interval)
+	{
+		if (IntervalToTicks(interval) >= LAZY_WINDOW)
+		{
+			return false;
+		}
+		unsigned expire_tick = (unsigned)CalcExpireTick(interval) & LAZY_TICK_MASK;
+		unsigned long long state = timer_task->GetLazyState();
+		for (;;)
+		{
+			/*Բ˵ѾͷŻ߱·,޸*/
+			if ((unsigned)(state >> 32) != generation)
+			{
+				return true;
+			}
+			if (!(state & LAZY_ARMED))
+			{
+				return false;
+			}
+			int diff = LazyTickDiff(expire_tick, (unsigned)state & LAZY_TICK_MASK);
+			if (diff < 0)
+			{
+				return false;
+			}
+			if (diff == 0)
+			{
+				TIMER_STAT(TimerStats::RecordReschedule());
+				return true;
+			}
+			unsigned long long new_state = (state & ~(unsigned long long)LAZY_TICK_MASK) | expire_tick;
+			if (timer_task->CompareExchangeLazyState(state, new_state))
+			{
+				TIMER_STAT(TimerStats::RecordReschedule());
+				return true;
+			}
+		}
+	}
+
+	void TimerManager::PublishExpireTick(TimerTask* timer_task, bool keep_later)
+	{
+		unsigned long long state = timer_task->GetLazyState();
+		for (;;)
+		{
+			unsigned long long expire_tick = timer_task->GetExpireTick();
+			if (keep_later && (state & LAZY_ARMED))
+			{
+				int diff = LazyTickDiff((unsigned)state & LAZY_TICK_MASK, (unsigned)expire_tick & LAZY_TICK_MASK);
+				if (diff > 0)
+				{
+					timer_task->SetExpireTick(expire_tick + diff);
+					return;
+				}
+			}
+			/*ڿ̶뵱ǰ̫Զʱ31λȽϻ,ƺ*/
+			bool armed = expire_tick - GetQueueTick() < LAZY_WINDOW;
+			unsigned long long new_state = (state & 0xFFFFFFFF00000000ULL) |
+				(armed ? (unsigned long long)LAZY_ARMED : 0ULL) | ((unsigned)expire_tick & LAZY_TICK_MASK);
+			if (timer_task->CompareExchangeLazyState(state, new_state))
+			{
+				return;
+			}
+		}
+	}
+
+	unsigned long long TimerManager::GetLazyExpireTick(TimerTask* timer_task)
+	{
+		unsigned long long state = timer_task->GetLazyState();
+		unsigned long long expire_tick = timer_task->GetExpireTick();
+		if (!(state & LAZY_ARMED))
+		{
+			return expire_tick;
+		}
+		int diff = LazyTickDiff((unsigned)state & LAZY_TICK_MASK, (unsigned)expire_tick & LAZY_TICK_MASK);
+		return diff > 0 ? expire_tick + diff : expire_tick;
+	}
+
+	bool TimerManager::DisarmBeforeFire(TimerTask* timer_task)
+	{
+		unsigned long long state = timer_task->GetLazyState();
+		for (;;)
+		{
+			unsigned long long lazy_expire = GetLazyExpireTick(timer_task);
+			if (lazy_expire > timer_task->GetExpireTick())
+			{
+				timer_task->SetExpireTick(lazy_expire);
+				return false;
+			}
+			/*ζʱ֮ٽܶƺ,֮ҪͶ·ʱ*/
+			if (timer_task->GetTimerType() == CIRCLE || !(state & LAZY_ARMED) ||
+				timer_task->CompareExchangeLazyState(state, state & ~(unsigned long long)LAZY_ARMED))
+			{
+				return true;
+			}
+		}
+	}
+
+	int TimerManager::LazyTickDiff(unsigned tick1, unsigned tick2)
+	{
+		return (int)((tick1 - tick2) << 1) >> 1;
+	}
+
+	unsigned long long TimerManager::CalcExpireTick(unsigned interval)
+	{
+		return DeadlineToTick(system_time_.GetCurrentNanoseconds(), interval);
+	}
+
+	unsigned long long TimerManager::DeadlineToTick(unsigned long long now_ns, unsigned interval)
+	{
+		/*ȡ,֤ʱǰ;
+		*ʱǰѾȥĲֻᱻ,ǰ1ms*/
+		unsigned long long deadline_ns = now_ns - start_time_ * 1000000ULL + (unsigned long long)interval * 1000000ULL;
+		unsigned long long tick_ns = (unsigned long long)tick_ms_ * 1000000ULL;
+		return (deadline_ns + tick_ns - 1) / tick_ns;
+	}
+
+	void TimerManager::InsertTimer(TimerTask* timer_task)
+	{
+		timer_task->SetVectorIndex(use_heap_ ? timer_heap_->Insert(timer_task) : timer_wheel_->Insert(timer_task));
+	}
+
+	void TimerManager::AddTimers(TimerTask** timer_tasks, int count)
+	{
+		if (count <= 0)
+		{
+			return;
+		}
+
+		TIMER_STAT(TimerStats::RecordArm(count));
+		unsigned long long now_ns = system_time_.GetCurrentNanoseconds();
+		for (int i = 0; i < count; i++)
+		{
+			TimerTask* timer_task = timer_tasks[i];
+			timer_task->SetExpireTick(DeadlineToTick(now_ns, timer_task->GetIntervalTime()));
+			PublishExpireTick(timer_task, false);
+		}
+		if (use_heap_)
+		{
+			timer_heap_->InsertBatch(timer_tasks, count);
+		}
+		else
+		{
+			timer_wheel_->InsertBatch(timer_tasks, count);
+		}
+		for (int i = 0; i < count; i++)
+		{
+			timer_tasks[i]->SetVectorIndex(timer_tasks[i]->slot_);
+		}
+	}
+
+	void TimerManager::RemoveTimers(TimerTask** timer_tasks, int count)
+	{
+		int removed = use_heap_ ? timer_heap_->RemoveBatch(timer_tasks, count) : timer_wheel_->RemoveBatch(timer_tasks, count);
+		TIMER_STAT(TimerStats::RecordCancel(removed));
+		(void)removed;
+	}
+
+	void TimerManager::RemoveTimer(TimerTask* timer_task)
+	{
+		//ֻͳƻڵȴڵĶʱ
+		TIMER_STAT(if (IsQueued(timer_task)) TimerStats::RecordCancel());
+		if (use_heap_)
+		{
+			timer_heap_->Remove(timer_task);
+		}
+		else
+		{
+			timer_wheel_->Remove(timer_task);
+		}
+	}
+
+	void TimerManager::DetectTimers()
+	{
+		TIMER_STAT(TimerStats::BeginDetect());
+		WheelHandler handler = { this, GetCurrentTick() };
+		if (use_heap_)
+		{
+			timer_heap_->AdvanceTo(handler.now_tick, handler);
+			TIMER_STAT(TimerStats::EndDetect(*timer_heap_));
+		}
+		else
+		{
+			timer_wheel_->AdvanceTo(handler.now_tick, handler);
+			TIMER_STAT(TimerStats::EndDetect(*timer_wheel_));
+		}
+	}
+
+	void TimerManager::WheelHandler::OnCascade(TimerWheelHook* node)
+	{
+		TIMER_STAT(TimerStats::RecordCascade());
+		TimerTask* timer_task = static_cast<TimerTask*>(node);
+		timer_task->SetExpireTick(manager->GetLazyExpireTick(timer_task));
+	}
+
+	void TimerManager::WheelHandler::OnExpire(TimerWheelHook* node)
+	{
+		TimerTask* timer_task = static_cast<TimerTask*>(node);
+		if (!manager->DisarmBeforeFire(timer_task))
+		{
+			/*ʱ䱻ƺ,,µĿ̶·*/
+			manager->InsertTimer(timer_task);
+			return;
+		}
+		TIMER_STAT(TimerStats::RecordFire((manager->start_time_ + timer_task->GetExpireTick() * manager->tick_ms_) * 1000000ULL));
+		timer_task->HandleTask(manager->dispatcher_);
+		if (timer_task->GetVectorIndex() != -1 && !manager->IsQueued(timer_task))
+		{
+			/*ѭʱϴεĵڿ̶ۼ,ܻصʱӰ;
+			*̫ͣʱ,:һεڵǰ̶֮ĵһ*/
+			unsigned long long ticks = manager->IntervalToTicks(timer_task->GetIntervalTime());
+			unsigned long long expire_tick = timer_task->GetExpireTick() + ticks;
+			if (expire_tick <= now_tick)
+			{
+				expire_tick += ((now_tick - expire_tick) / ticks + 1) * ticks;
+			}
+			timer_task->SetExpireTick(expire_tick);
+			manager->PublishExpireTick(timer_task, true);
+			manager->InsertTimer(timer_task);
+		}
+	}
+
+	bool TimerManager::GetNextPendingTick(unsigned long long* next_tick)
+	{
+		return use_heap_ ? timer_heap_->GetNextPendingTick(next_tick) : timer_wheel_->GetNextPendingTick(next_tick);
+	}
+
+	unsigned TimerManager::GetWaitTime(void)
+	{
+		unsigned long long next_tick = GetQueueTick();
+		if (GetTimerCount() == 0)
+		{
+			return INFINITE;
+		}
+		//Ѱ1ms̶ȼʱ,ֻܰĵʱȴ
+		if ((tickless_ || use_heap_) && !GetNextPendingTick(&next_tick))
+		{
+			return INFINITE;
+		}
+
+		unsigned long long next_time = start_time_ + next_tick * tick_ms_;
+		unsigned long long now = system_time_.GetCurrentMilliseconds();
+		if (next_time <= now)
+		{
+			return 0;
+		}
+		if (next_time - now >= INFINITE)
+		{
+			return INFINITE - 1;
+		}
+		return (unsigned)(next_time - now);
+	}
+
+	TimerCommandQueue::TimerCommandQueue()
+	{
+		stub_.next_.store(NULL, std::memory_order_relaxed);
+		head_.store(&stub_, std::memory_order_relaxed);
+		tail_ = &stub_;
+	}
+
+	TimerCommandQueue::~TimerCommandQueue()
+	{
+		TimerCommand* command = NULL;
+		while ((command = Pop()) != NULL)
+		{
+			delete command;
+		}
+	}
+
+	void TimerCommandQueue::Push(TimerCommand* command)
+	{
+		command->next_.store(NULL, std::memory_order_relaxed);
+		TimerCommand* prev = head_.exchange(command, std::memory_order_acq_rel);
+		prev->next_.store(command, std::memory_order_release);
+	}
+
+	TimerCommand* TimerCommandQueue::Pop()
+	{
+		TimerCommand* tail = tail_;
+		TimerCommand* next = tail->next_.load(std::memory_order_acquire);
+		if (tail == &stub_)
+		{
+			if (next == NULL)
+			{
+				return NULL;
+			}
+			tail_ = next;
+			tail = next;
+			next = next->next_.load(std::memory_order_acquire);
+		}
+		if (next != NULL)
+		{
+			tail_ = next;
+			return tail;
+		}
+
+		/*tailѾһڵ:(ѽhead_ûnext_),
+		*ȷNULL,´ȡ*/
+		if (tail != head_.load(std::memory_order_acquire))
+		{
+			return NULL;
+		}
+		Push(&stub_);
+		next = tail->next_.load(std::memory_order_acquire);
+		if (next != NULL)
+		{
+			tail_ = next;
+			return tail;
+		}
+		return NULL;
+	}
+
+	TimerThread::TimerThread(unsigned tick_ms)
+		: timer_manager_(tick_ms)
+	{
+		exit_flag_ = FALSE;
+		wakeup_count_ = 0;
+		time_period_set_ = FALSE;
+		timer_count_ = 0;
+		dispatcher_ = NULL;
+		dispatch_threads_ = 0;
+	}
+
+	TimerThread::~TimerThread()
+	{
+		StopTimerThread();
+		ProcessCommands();
+		ClearTasks();
+	}
+
+	void TimerThread::ThreadWorkFunc(THREAD_PARAMETERS*)
+	{
+		while (!exit_flag_)
+		{
+			wakeup_count_.fetch_add(1, std::memory_order_relaxed);
+			/*ȸλ¼ٴ,λ֮Ͷݵĵȴ*/
+			comm_event_.ResetEvent();
+			MonotonicClock::UpdateCachedNow();
+			ProcessCommands();
+			timer_manager_.DetectTimers();
+			bool flushed = dispatcher_ == NULL || dispatcher_->Flush();
+			if (exit_flag_)
+			{
+				break;
+			}
+
+			//ֻߵһҪĿ̶,ڼµ(ܸ)ʱʱǰ
+			unsigned wait_time = timer_manager_.GetWaitTime();
+			if (!flushed && wait_time > 1)
+			{
+				//ַ,µĻص1ms֮Ͷ
+				wait_time = 1;
+			}
+			if (wait_time == INFINITE)
+			{
+				comm_event_.WaitForEventSignaled();
+			}
+			else if (wait_time > 0)
+			{
+				comm_event_.WaitForEventSignaled(wait_time > 0x7fffffff ? 0x7fffffff : (int)wait_time);
+			}
+		}
+
+		ProcessCommands();
+		ClearTasks();
+	}
+
+	void TimerThread::PostCommand(TimerCommandType cmd_type, TimerTask* timer_task, TimerHandle timer_handle, unsigned interval_time)
+	{
+		TimerCommand* command = new TimerCommand();
+		command->cmd_type_ = cmd_type;
+		command->timer_task_ = timer_task;
+		command->timer_handle_ = timer_handle;
+		command->batch_tasks_ = NULL;
+		command->batch_handles_ = NULL;
+		command->batch_count_ = 0;
+		command->interval_time_ = interval_time;
+		command_queue_.Push(command);
+		comm_event_.SetEvent();
+	}
+
+	void TimerThread::ProcessCommands()
+	{
+		TimerCommand* command = NULL;
+		while ((command = command_queue_.Pop()) != NULL)
+		{
+			if (command->cmd_type_ == TIMER_CMD_ADD_BATCH || command->cmd_type_ == TIMER_CMD_CANCEL_BATCH)
+			{
+				ProcessBatchCommand(command);
+				delete command;
+				continue;
+			}
+			if (command->cmd_type_ == TIMER_CMD_RELEASE)
+			{
+				//ִ߳Ѿֹͣ
+				delete command->timer_task_;
+				delete command;
+				continue;
+			}
+
+			TimerTask* timer_task = command->timer_task_;
+			if (command->cmd_type_ != TIMER_CMD_ADD)
+			{
+				timer_task = FindOwnTask(command->timer_handle_);
+				if (timer_task == NULL)
+				{
+					delete command;//ѾʧЧ
+					continue;
+				}
+			}
+			switch (command->cmd_type_)
+			{
+			case TIMER_CMD_ADD:
+				timer_manager_.AddTimer(timer_task);
+				RegisterTask(timer_task);
+				break;
+			case TIMER_CMD_CANCEL:
+				timer_manager_.RemoveTimer(timer_task);
+				UnregisterTask(timer_task);
+				DeleteTask(timer_task);
+				break;
+			case TIMER_CMD_RESCHEDULE:
+				timer_manager_.RescheduleTimer(timer_task, command->interval_time_);
+				break;
+			default:
+				break;
+			}
+			delete command;
+		}
+	}
+
+	void TimerThread::ProcessBatchCommand(TimerCommand* command)
+	{
+		if (command->cmd_type_ == TIMER_CMD_ADD_BATCH)
+		{
+			timer_manager_.AddTimers(command->batch_tasks_, command->batch_count_);
+			task_table_.reserve(task_table_.size() + command->batch_count_);
+			for (int i = 0; i < command->batch_count_; i++)
+			{
+				RegisterTask(command->batch_tasks_[i]);
+			}
+			delete[] command->batch_tasks_;
+			return;
+		}
+
+		std::vector<TimerTask*> cancel_tasks;
+		cancel_tasks.reserve(command->batch_count_);
+		for (int i = 0; i < command->batch_count_; i++)
+		{
+			TimerTask* timer_task = FindOwnTask(command->batch_handles_[i]);
+			//ͬһֶܳ,һξѾע,ֻͷһ
+			if (timer_task != NULL && timer_task->GetRegistryIndex() >= 0)
+			{
+				UnregisterTask(timer_task);
+				cancel_tasks.push_back(timer_task);
+			}
+		}
+		delete[] command->batch_handles_;
+		if (cancel_tasks.empty())
+		{
+			return;
+		}
+
+		timer_manager_.RemoveTimers(&cancel_tasks[0], (int)cancel_tasks.size());
+		for (size_t i = 0; i < cancel_tasks.size(); i++)
+		{
+			DeleteTask(cancel_tasks[i]);
+		}
+	}
+
+	void TimerThread::RegisterTask(TimerTask* timer_task)
+	{
+		timer_task->SetRegistryIndex((int)task_table_.size());
+		task_table_.push_back(timer_task);
+		timer_count_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void TimerThread::UnregisterTask(TimerTask* timer_task)
+	{
+		int registry_index = timer_task->GetRegistryIndex();
+		TimerTask* last_task = task_table_.back();
+		task_table_[registry_index] = last_task;
+		last_task->SetRegistryIndex(registry_index);
+		task_table_.pop_back();
+		timer_task->SetRegistryIndex(-1);
+		timer_count_.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void TimerThread::ClearTasks()
+	{
+		while (!task_table_.empty())
+		{
+			TimerTask* tmp_task = task_table_.back();
+			task_table_.pop_back();
+			timer_manager_.RemoveTimer(tmp_task);
+			tmp_task->SetRegistryIndex(-1);
+			DeleteTask(tmp_task);
+		}
+		timer_count_ = 0;
+	}
+
+	void TimerThread::DeleteTask(TimerTask* timer_task)
+	{
+		if (timer_task->ReleaseTask())
+		{
+			delete timer_task;
+		}
+	}
+
+	TimerTask* TimerThread::FindOwnTask(TimerHandle timer_handle)
+	{
+		/*ֻĶʱ߳ͷ,￴ĴЧʱ񲻻ᱻͷ.
+		*Ѿֹͣصڹִ߳е,ҲЧ*/
+		TimerTask* timer_task = TimerTask::FromHandle(timer_handle);
+		if (timer_task == NULL || timer_task->GetOwner() != this || timer_task->GetRegistryIndex() < 0)
+		{
+			return NULL;
+		}
+		return timer_task;
+	}
+
+	TimerHandle TimerThread::SetATimer(TimerNotify* timer_notify, unsigned interval_time, TimerType timeType)
+	{
+		if (interval_time >= 0xFFFFFFFFUL)
+		{
+			return 0;
+		}
+		TimerTask* timer_task = new TimerTask();
+		if (timer_task == NULL)
+		{
+			return 0;
+		}
+		timer_task->SetTimerTask(timer_notify, interval_time, timeType);
+		return ArmTimerTask(timer_task, interval_time);
+	}
+
+	TimerHandle TimerThread::ArmTimerTask(TimerTask* timer_task, unsigned interval_time)
+	{
+		timer_task->SetOwner(this);
+		timer_task->InitLazyState();
+		/*Ͷܱ֮ʱ߳ͷ,Ҫȡ*/
+		TimerHandle timer_handle = timer_task->GetHandle();
+		PostCommand(TIMER_CMD_ADD, timer_task, timer_handle, interval_time);
+		return timer_handle;
+	}
+
+	int TimerThread::SetTimers(const TimerSetting* settings, int count, TimerHandle* timer_handles)
+	{
+		if (settings == NULL || timer_handles == NULL || count <= 0)
+		{
+			return 0;
+		}
+
+		TimerTask** batch_tasks = new TimerTask*[count];
+		int batch_count = 0;
+		for (int i = 0; i < count; i++)
+		{
+			timer_handles[i] = 0;
+			if (settings[i].interval_time >= 0xFFFFFFFFUL)
+			{
+				continue;
+			}
+			TimerTask* timer_task = new TimerTask();
+			timer_task->SetTimerTask(settings[i].timer_notify, settings[i].interval_time, settings[i].timer_type);
+			timer_task->SetOwner(this);
+			timer_task->InitLazyState();
+			timer_handles[i] = timer_task->GetHandle();
+			batch_tasks[batch_count++] = timer_task;
+		}
+		if (batch_count == 0)
+		{
+			delete[] batch_tasks;
+			return 0;
+		}
+
+		TimerCommand* command = new TimerCommand();
+		command->cmd_type_ = TIMER_CMD_ADD_BATCH;
+		command->timer_task_ = NULL;
+		command->timer_handle_ = 0;
+		command->interval_time_ = 0;
+		command->batch_tasks_ = batch_tasks;
+		command->batch_handles_ = NULL;
+		command->batch_count_ = batch_count;
+		command_queue_.Push(command);
+		comm_event_.SetEvent();
+		return batch_count;
+	}
+
+	void TimerThread::StopTimers(const TimerHandle* timer_handles, int count)
+	{
+		if (timer_handles == NULL || count <= 0)
+		{
+			return;
+		}
+
+		TimerCommand* command = new TimerCommand();
+		command->cmd_type_ = TIMER_CMD_CANCEL_BATCH;
+		command->timer_task_ = NULL;
+		command->timer_handle_ = 0;
+		command->interval_time_ = 0;
+		command->batch_tasks_ = NULL;
+		command->batch_handles_ = new TimerHandle[count];
+		command->batch_count_ = count;
+		std::copy(timer_handles, timer_handles + count, command->batch_handles_);
+		command_queue_.Push(command);
+		comm_event_.SetEvent();
+	}
+
+	void TimerThread::StopATimer(TimerHandle timer_handle)
+	{
+		if (timer_handle == 0)
+		{
+			return;
+		}
+		PostCommand(TIMER_CMD_CANCEL, NULL, timer_handle, 0);
+	}
+
+	void TimerThread::RescheduleTimer(TimerHandle timer_handle, unsigned interval_time, bool lazy)
+	{
+		if (timer_handle == 0 || interval_time >= 0xFFFFFFFFUL)
+		{
+			return;
+		}
+		if (lazy)
+		{
+			/*ֻƺʱʱͶ,ʧ(ǰѴ)ʱ*/
+			TimerTask* timer_task = TimerTask::FromHandle(timer_handle);
+			if (timer_task == NULL || timer_task->GetOwner() != this ||
+				timer_manager_.PostponeTimer(timer_task, (unsigned)(timer_handle >> 32), interval_time))
+			{
+				return;
+			}
+		}
+		PostCommand(TIMER_CMD_RESCHEDULE, NULL, timer_handle, interval_time);
+	}
+
+	void TimerThread::SetTicklessMode(bool tickless)
+	{
+		timer_manager_.SetTicklessMode(tickless);
+	}
+
+	bool TimerThread::SetQueuePolicy(TimerQueuePolicy policy, unsigned expected_timers)
+	{
+		return timer_manager_.SetQueuePolicy(policy, expected_timers);
+	}
+
+	void TimerThread::SetDispatchThreads(int thread_count)
+	{
+		dispatch_threads_ = thread_count;
+	}
+
+	unsigned long long TimerThread::GetWakeupCount()
+	{
+		return wakeup_count_.load(std::memory_order_relaxed);
+	}
+
+	unsigned TimerThread::GetTimerCount()
+	{
+		return timer_count_.load(std::memory_order_relaxed);
+	}
+
+	BOOL TimerThread::StartTimerThread(int core_id)
+	{
+		exit_flag_ = FALSE;
+#ifdef _WIN32
+		/*ϵͳĬϵĶʱԼ15ms,̶ȸСʱҪ߾*/
+		if (timer_manager_.GetTickInterval() < 15 && !time_period_set_)
+		{
+			time_period_set_ = (timeBeginPeriod(1) == TIMERR_NOERROR);
+		}
+#endif
+		if (dispatch_threads_ > 0 && dispatcher_ == NULL)
+		{
+			dispatcher_ = new TimerDispatcher();
+			if (!dispatcher_->StartDispatcher(dispatch_threads_))
+			{
+				delete dispatcher_;
+				dispatcher_ = NULL;
+				return FALSE;
+			}
+			timer_manager_.SetDispatcher(dispatcher_);
+		}
+		if (!CreateThread())
+		{
+			return FALSE;
+		}
+		if (core_id >= 0)
+		{
+			SetThreadAffinity(0, core_id);
+		}
+		return TRUE;
+	}
+	
+	void TimerThread::StopTimerThread()
+	{
+		exit_flag_ = TRUE;
+		DestroyThreads();
+		/*ʱ߳˳ֹ֮ͣ߳,ִеĻص֮ͷڶ,
+		*´ʱ*/
+		if (dispatcher_ != NULL)
+		{
+			dispatcher_->StopDispatcher();
+			delete dispatcher_;
+			dispatcher_ = NULL;
+			timer_manager_.SetDispatcher(NULL);
+		}
+#ifdef _WIN32
+		if (time_period_set_)
+		{
+			timeEndPeriod(1);
+			time_period_set_ = FALSE;
+		}
+#endif
+	}
+
+	void TimerThread::OnBeforeThreadExiting()
+	{
+		/*ڵȴĶʱ߳,Լͷжʱ*/
+		exit_flag_ = TRUE;
+		comm_event_.SetEvent();
+	}
+
+	TimerDispatcher::TimerDispatcher()
+		: worker_count_(0), sleepers_(0), exit_flag_(false), idle_sem_(NULL)
+	{
+	}
+
+	TimerDispatcher::~TimerDispatcher()
+	{
+		StopDispatcher();
+	}
+
+	BOOL TimerDispatcher::StartDispatcher(int thread_count)
+	{
+		if (thread_count <= 0)
+		{
+			return FALSE;
+		}
+		StopDispatcher();
+		exit_flag_ = false;
+		worker_count_ = thread_count;
+		idle_sem_ = new CommonSemaphore(0, thread_count);
+		if (!CreateThread(thread_count))
+		{
+			StopDispatcher();
+			return FALSE;
+		}
+		return TRUE;
+	}
+
+	void TimerDispatcher::StopDispatcher()
+	{
+		exit_flag_ = true;
+		DestroyThreads();
+
+		for (size_t i = 0; i < batch_.size(); i++)
+		{
+			FinishTask(batch_[i]);
+		}
+		batch_.clear();
+		TimerTask* timer_task = NULL;
+		while (queue_.Pop(timer_task))
+		{
+			FinishTask(timer_task);
+		}
+		if (idle_sem_ != NULL)
+		{
+			delete idle_sem_;
+			idle_sem_ = NULL;
+		}
+		sleepers_ = 0;
+		worker_count_ = 0;
+	}
+
+	int TimerDispatcher::GetThreadCount()
+	{
+		return worker_count_;
+	}
+
+	void TimerDispatcher::Dispatch(TimerTask* timer_task)
+	{
+		/*ѭʱһεĻصŶӻִ,һ,붨ʱ֮߳ͣһ*/
+		if (timer_task->GetTimerType() == CIRCLE && timer_task->IsDispatching())
+		{
+			return;
+		}
+		timer_task->AddDispatchRef();
+		batch_.push_back(timer_task);
+	}
+
+	bool TimerDispatcher::Flush()
+	{
+		int count = (int)batch_.size();
+		if (count == 0)
+		{
+			return true;
+		}
+		int pushed = queue_.PushBatch(&batch_[0], count);
+		if (pushed == count)
+		{
+			batch_.clear();
+			WakeWorkers(count);
+			return true;
+		}
+
+		/*ʱȴ߳:ûŽȥѭʱһ,Dispatchһ;
+		*ζʱԭ˳batch_,ʱ߳һͶ*/
+		size_t kept = 0;
+		for (int i = pushed; i < count; i++)
+		{
+			if (batch_[i]->GetTimerType() == CIRCLE)
+			{
+				FinishTask(batch_[i]);
+			}
+			else
+			{
+				batch_[kept++] = batch_[i];
+			}
+		}
+		batch_.resize(kept);
+		WakeWorkers(worker_count_);
+		return kept == 0;
+	}
+
+	void TimerDispatcher::WakeWorkers(int count)
+	{
+		/*ParkWorkerе:Ҫô￴˯,Ҫô˯߿*/
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int sleepers = sleepers_.load(std::memory_order_relaxed);
+		while (sleepers > 0 && count > 0)
+		{
+			if (sleepers_.compare_exchange_weak(sleepers, sleepers - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				idle_sem_->ReleaseSemObject();
+				sleepers--;
+				count--;
+			}
+		}
+	}
+
+	void TimerDispatcher::ParkWorker()
+	{
+		sleepers_.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!queue_.IsEmpty() || exit_flag_.load(std::memory_order_acquire))
+		{
+			/*˯ߵǼ;Ѿߵֿ,źͷ,ȴ*/
+			int sleepers = sleepers_.load(std::memory_order_relaxed);
+			while (sleepers > 0)
+			{
+				if (sleepers_.compare_exchange_weak(sleepers, sleepers - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					return;
+				}
+			}
+		}
+		idle_sem_->WaitForSemSignaled();
+	}
+
+	void TimerDispatcher::ThreadWorkFunc(THREAD_PARAMETERS*)
+	{
+		TimerTask* timer_task = NULL;
+		while (!exit_flag_.load(std::memory_order_acquire))
+		{
+			if (!queue_.Pop(timer_task))
+			{
+				ParkWorker();
+				continue;
+			}
+			timer_task->RunCallback();
+			FinishTask(timer_task);
+		}
+	}
+
+	void TimerDispatcher::OnBeforeThreadExiting()
+	{
+		/*˯ߵĹ߳,Ǽ˳־*/
+		exit_flag_ = true;
+		if (idle_sem_ == NULL)
+		{
+			return;
+		}
+		for (int i = 0; i < worker_count_; i++)
+		{
+			idle_sem_->ReleaseSemObject();
+		}
+	}
+
+	void TimerDispatcher::FinishTask(TimerTask* timer_task)
+	{
+		if (timer_task->ReleaseDispatchRef())
+		{
+			timer_task->GetOwner()->PostCommand(TIMER_CMD_RELEASE, timer_task, 0, 0);
+		}
+	}
+
+	ShardedTimerService::ShardedTimerService()
+	{
+	}
+
+	ShardedTimerService::~ShardedTimerService()
+	{
+		StopService();
+	}
+
+	BOOL ShardedTimerService::StartService(int shard_count, bool bind_core, unsigned tick_ms)
+	{
+		int core_count = (int)std::thread::hardware_concurrency();
+		if (core_count <= 0)
+		{
+			core_count = 1;
+		}
+		if (shard_count <= 0)
+		{
+			shard_count = core_count;
+		}
+
+		StopService();
+		for (int i = 0; i < shard_count; i++)
+		{
+			TimerThread* shard = new TimerThread(tick_ms);
+			shards_.push_back(shard);
+			if (!shard->StartTimerThread(bind_core ? i % core_count : -1))
+			{
+				StopService();
+				return FALSE;
+			}
+		}
+		return TRUE;
+	}
+
+	void ShardedTimerService::StopService()
 	{
-		exit_flag_ = TRUE;
+		for (size_t i = 0; i < shards_.size(); i++)
+		{
+			shards_[i]->StopTimerThread();
+			delete shards_[i];
+		}
+		shards_.clear();
+	}
+
+	int ShardedTimerService::GetShardCount()
+	{
+		return (int)shards_.size();
+	}
+
+	TimerHandle ShardedTimerService::SetATimer(TimerNotify* timer_notify, unsigned interval_time, TimerType timeType)
+	{
+		if (shards_.empty())
+		{
+			return 0;
+		}
+		return shards_[SelectShardByThread()]->SetATimer(timer_notify, interval_time, timeType);
+	}
+
+	TimerHandle ShardedTimerService::SetATimerByKey(unsigned long long key, TimerNotify* timer_notify, unsigned interval_time, TimerType timeType)
+	{
+		if (shards_.empty())
+		{
+			return 0;
+		}
+		return shards_[SelectShardByKey(key)]->SetATimer(timer_notify, interval_time, timeType);
+	}
+
+	void ShardedTimerService::StopATimer(TimerHandle timer_handle)
+	{
+		/*ͬʱͷŲָķƬ,ĴԲ,ĿƬ*/
+		TimerTask* timer_task = TimerTask::FromHandle(timer_handle);
+		TimerThread* owner = timer_task != NULL ? timer_task->GetOwner() : NULL;
+		if (owner == NULL)
+		{
+			return;
+		}
+		owner->StopATimer(timer_handle);
+	}
+
+	void ShardedTimerService::RescheduleTimer(TimerHandle timer_handle, unsigned interval_time, bool lazy)
+	{
+		TimerTask* timer_task = TimerTask::FromHandle(timer_handle);
+		TimerThread* owner = timer_task != NULL ? timer_task->GetOwner() : NULL;
+		if (owner == NULL)
+		{
+			return;
+		}
+		owner->RescheduleTimer(timer_handle, interval_time, lazy);
+	}
+
+	int ShardedTimerService::SetTimers(const TimerSetting* settings, int count, TimerHandle* timer_handles)
+	{
+		if (timer_handles == NULL)
+		{
+			return 0;
+		}
+		if (shards_.empty())
+		{
+			for (int i = 0; i < count; i++)
+			{
+				timer_handles[i] = 0;
+			}
+			return 0;
+		}
+		return shards_[SelectShardByThread()]->SetTimers(settings, count, timer_handles);
+	}
+
+	void ShardedTimerService::StopTimers(const TimerHandle* timer_handles, int count)
+	{
+		if (timer_handles == NULL || count <= 0)
+		{
+			return;
+		}
+		std::map<TimerThread*, std::vector<TimerHandle> > shard_handles;
+		for (int i = 0; i < count; i++)
+		{
+			TimerTask* timer_task = TimerTask::FromHandle(timer_handles[i]);
+			TimerThread* owner = timer_task != NULL ? timer_task->GetOwner() : NULL;
+			if (owner != NULL)
+			{
+				shard_handles[owner].push_back(timer_handles[i]);
+			}
+		}
+		std::map<TimerThread*, std::vector<TimerHandle> >::iterator it = shard_handles.begin();
+		for (; it != shard_handles.end(); ++it)
+		{
+			it->first->StopTimers(&it->second[0], (int)it->second.size());
+		}
+	}
+
+	int ShardedTimerService::SelectShardByThread()
+	{
+		/*ÿ̵߳һεʱһ,֮ͬһƬ*/
+		static std::atomic<unsigned> thread_sequence(0);
+		static thread_local unsigned thread_no = thread_sequence.fetch_add(1, std::memory_order_relaxed);
+		return (int)(thread_no % shards_.size());
+	}
+
+	int ShardedTimerService::SelectShardByKey(unsigned long long key)
+	{
+		/*ȴɢkeyĸλ,keyƬ*/
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return (int)(key % shards_.size());
+	}
+
+	WorkStealingDeque::WorkStealingDeque(int capacity)
+		: top_(0), bottom_(0)
+	{
+		long long size = 1;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		TaskArray* array = new TaskArray;
+		array->capacity = size;
+		array->buffer = new std::atomic<PoolTask*>[size];
+		array_.store(array, std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque::~WorkStealingDeque()
+	{
+		PoolTask* task = NULL;
+		while ((task = Pop()) != NULL)
+		{
+			task->Discard();
+		}
+		retired_arrays_.push_back(array_.load(std::memory_order_relaxed));
+		for (size_t i = 0; i < retired_arrays_.size(); i++)
+		{
+			delete[] retired_arrays_[i]->buffer;
+			delete retired_arrays_[i];
+		}
+	}
+
+	WorkStealingDeque::TaskArray* WorkStealingDeque::GrowArray(TaskArray* array, long long bottom, long long top)
+	{
+		TaskArray* new_array = new TaskArray;
+		new_array->capacity = array->capacity * 2;
+		new_array->buffer = new std::atomic<PoolTask*>[new_array->capacity];
+		for (long long i = top; i < bottom; i++)
+		{
+			new_array->buffer[i & (new_array->capacity - 1)].store(
+				array->buffer[i & (array->capacity - 1)].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		retired_arrays_.push_back(array);
+		return new_array;
+	}
+
+	void WorkStealingDeque::Push(PoolTask* task)
+	{
+		long long bottom = bottom_.load(std::memory_order_relaxed);
+		long long top = top_.load(std::memory_order_acquire);
+		TaskArray* array = array_.load(std::memory_order_relaxed);
+		if (bottom - top > array->capacity - 1)
+		{
+			array = GrowArray(array, bottom, top);
+			array_.store(array, std::memory_order_release);
+		}
+		array->buffer[bottom & (array->capacity - 1)].store(task, std::memory_order_relaxed);
+		bottom_.store(bottom + 1, std::memory_order_release);
+	}
+
+	PoolTask* WorkStealingDeque::Pop()
+	{
+		long long bottom = bottom_.load(std::memory_order_relaxed) - 1;
+		TaskArray* array = array_.load(std::memory_order_relaxed);
+		bottom_.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long top = top_.load(std::memory_order_relaxed);
+
+		PoolTask* task = NULL;
+		if (top <= bottom)
+		{
+			task = array->buffer[bottom & (array->capacity - 1)].load(std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				/*ֻʣһ,ȡ߾*/
+				if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					task = NULL;
+				}
+				bottom_.store(bottom + 1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return task;
+	}
+
+	PoolTask* WorkStealingDeque::Steal()
+	{
+		long long top = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long bottom = bottom_.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return NULL;
+		}
+
+		TaskArray* array = array_.load(std::memory_order_acquire);
+		PoolTask* task = array->buffer[top & (array->capacity - 1)].load(std::memory_order_relaxed);
+		if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return NULL;//߳ȡ
+		}
+		return task;
+	}
+
+	bool WorkStealingDeque::IsEmpty() const
+	{
+		return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+	}
+
+	PoolTaskQueue::PoolTaskQueue()
+	{
+		head_.store(&stub_, std::memory_order_relaxed);
+		tail_ = &stub_;
+	}
+
+	PoolTaskQueue::~PoolTaskQueue()
+	{
+		PoolTask* task = NULL;
+		while ((task = Pop()) != NULL)
+		{
+			task->Discard();
+		}
+	}
+
+	void PoolTaskQueue::Push(PoolTask* task)
+	{
+		task->next_.store(NULL, std::memory_order_relaxed);
+		PoolTask* prev = head_.exchange(task, std::memory_order_acq_rel);
+		prev->next_.store(task, std::memory_order_release);
+	}
+
+	PoolTask* PoolTaskQueue::Pop()
+	{
+		PoolTask* tail = tail_;
+		PoolTask* next = tail->next_.load(std::memory_order_acquire);
+		if (tail == &stub_)
+		{
+			if (next == NULL)
+			{
+				return NULL;
+			}
+			tail_ = next;
+			tail = next;
+			next = next->next_.load(std::memory_order_acquire);
+		}
+		if (next != NULL)
+		{
+			tail_ = next;
+			return tail;
+		}
+		if (tail != head_.load(std::memory_order_acquire))
+		{
+			return NULL;
+		}
+		Push(&stub_);
+		next = tail->next_.load(std::memory_order_acquire);
+		if (next != NULL)
+		{
+			tail_ = next;
+			return tail;
+		}
+		return NULL;
+	}
+
+	thread_local ThreadPool* ThreadPool::current_pool_ = NULL;
+	thread_local int ThreadPool::current_worker_ = -1;
+
+	ThreadPool::ThreadPool()
+		: submit_sequence_(0), inbox_tasks_(0), sleepers_(0), exit_flag_(false), idle_sem_(NULL)
+	{
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		StopPool();
+	}
+
+	BOOL ThreadPool::StartPool(int thread_count)
+	{
+		if (thread_count <= 0)
+		{
+			thread_count = (int)std::thread::hardware_concurrency();
+			if (thread_count <= 0)
+			{
+				thread_count = 1;
+			}
+		}
+
+		StopPool();
+		exit_flag_ = false;
+		idle_sem_ = new CommonSemaphore(0, thread_count);
+		for (int i = 0; i < thread_count; i++)
+		{
+			PoolWorker* worker = new PoolWorker;
+			worker->inbox_busy_ = false;
+			worker->random_seed_ = 0x9e3779b9u * (i + 1);
+			workers_.push_back(worker);
+		}
+		if (!CreateThread(thread_count))
+		{
+			StopPool();
+			return FALSE;
+		}
+		return TRUE;
+	}
+
+	void ThreadPool::StopPool()
+	{
+		exit_flag_ = true;
 		DestroyThreads();
+
+		/*ûִеֱӶ,Ӧfutureõbroken_promise*/
+		for (size_t i = 0; i < workers_.size(); i++)
+		{
+			delete workers_[i];
+		}
+		workers_.clear();
+		inbox_tasks_ = 0;
+		if (idle_sem_ != NULL)
+		{
+			delete idle_sem_;
+			idle_sem_ = NULL;
+		}
+		sleepers_ = 0;
 	}
-	void TimerThread::OnBeforeThreadExiting()
+
+	int ThreadPool::GetThreadCount()
+	{
+		return (int)workers_.size();
+	}
+
+	void ThreadPool::ThreadWorkFunc(THREAD_PARAMETERS* work_para)
+	{
+		int worker_index = work_para->thread_id;
+		current_pool_ = this;
+		current_worker_ = worker_index;
+
+		while (!exit_flag_.load(std::memory_order_acquire))
+		{
+			PoolTask* task = FindTask(worker_index);
+			if (task != NULL)
+			{
+				task->Execute();
+				continue;
+			}
+			ParkWorker();
+		}
+
+		current_pool_ = NULL;
+		current_worker_ = -1;
+	}
+
+	void ThreadPool::OnBeforeThreadExiting()
+	{
+		/*˯ߵĹ߳,Ǽ˳־*/
+		if (idle_sem_ == NULL)
+		{
+			return;
+		}
+		for (size_t i = 0; i < workers_.size(); i++)
+		{
+			idle_sem_->ReleaseSemObject();
+		}
+	}
+
+	void ThreadPool::PushTask(PoolTask* task)
+	{
+		if (workers_.empty())
+		{
+			task->Discard();//̳߳û
+			return;
+		}
+
+		if (current_pool_ == this)
+		{
+			/*߳ύѹԼĶ,̻߳ȡ*/
+			workers_[current_worker_]->deque_.Push(task);
+		}
+		else
+		{
+			unsigned index = submit_sequence_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+			inbox_tasks_.fetch_add(1, std::memory_order_relaxed);
+			workers_[index]->inbox_.Push(task);
+		}
+		WakeWorker();
+	}
+
+	void ThreadPool::PostTask(PoolTask* task)
+	{
+		if (workers_.empty())
+		{
+			task->Execute();
+			return;
+		}
+		PushTask(task);
+	}
+
+	PoolTask* ThreadPool::FindTask(int worker_index)
+	{
+		PoolWorker* self = workers_[worker_index];
+		PoolTask* task = self->deque_.Pop();
+		if (task != NULL)
+		{
+			return task;
+		}
+
+		task = TakeInbox(self, self);
+		if (task != NULL)
+		{
+			return task;
+		}
+
+		/*ѡ߳̿ʼ,γȡ*/
+		int worker_count = (int)workers_.size();
+		unsigned seed = self->random_seed_;
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		self->random_seed_ = seed;
+		int start = (int)(seed % worker_count);
+		for (int i = 0; i < worker_count; i++)
+		{
+			int victim = (start + i) % worker_count;
+			if (victim == worker_index)
+			{
+				continue;
+			}
+			task = workers_[victim]->deque_.Steal();
+			if (task != NULL)
+			{
+				return task;
+			}
+		}
+
+		/*߳æʱ,ռɿ̴߳ȡ*/
+		if (inbox_tasks_.load(std::memory_order_relaxed) > 0)
+		{
+			for (int i = 0; i < worker_count; i++)
+			{
+				int victim = (start + i) % worker_count;
+				task = TakeInbox(workers_[victim], self);
+				if (task != NULL)
+				{
+					return task;
+				}
+			}
+		}
+		return NULL;
+	}
+
+	PoolTask* ThreadPool::TakeInbox(PoolWorker* owner, PoolWorker* self)
+	{
+		/*ռֻһ,ñ־λ,ȡͷ,*/
+		if (owner->inbox_busy_.exchange(true, std::memory_order_acquire))
+		{
+			return NULL;
+		}
+
+		/*һֱӷ,תԼĶ,߳̿ȡ*/
+		int count = 0;
+		PoolTask* first = owner->inbox_.Pop();
+		if (first != NULL)
+		{
+			count++;
+			PoolTask* task = NULL;
+			while ((task = owner->inbox_.Pop()) != NULL)
+			{
+				self->deque_.Push(task);
+				count++;
+			}
+		}
+		owner->inbox_busy_.store(false, std::memory_order_release);
+
+		if (count > 0)
+		{
+			inbox_tasks_.fetch_sub(count, std::memory_order_relaxed);
+		}
+		return first;
+	}
+
+	bool ThreadPool::HelpOnce()
+	{
+		if (current_pool_ != this)
+		{
+			return false;
+		}
+		PoolTask* task = FindTask(current_worker_);
+		if (task == NULL)
+		{
+			return false;
+		}
+		task->Execute();
+		return true;
+	}
+
+	bool ThreadPool::HasPendingTask()
+	{
+		if (inbox_tasks_.load(std::memory_order_relaxed) > 0)
+		{
+			return true;
+		}
+		for (size_t i = 0; i < workers_.size(); i++)
+		{
+			if (!workers_[i]->deque_.IsEmpty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ThreadPool::WakeWorker()
+	{
+		/*ParkWorkerе:Ҫô￴˯,Ҫô˯߿*/
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int sleepers = sleepers_.load(std::memory_order_relaxed);
+		while (sleepers > 0)
+		{
+			/*ÿ˯ֻһ,źۻ*/
+			if (sleepers_.compare_exchange_weak(sleepers, sleepers - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				idle_sem_->ReleaseSemObject();
+				return;
+			}
+		}
+	}
+
+	void ThreadPool::ParkWorker()
 	{
-		while (task_list_.size() > 0)
+		sleepers_.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (HasPendingTask() || exit_flag_.load(std::memory_order_acquire))
 		{
-			TimerTask* tmp_task = task_list_.front();
-			StopATimer(tmp_task);
+			/*˯ߵǼ;Ѿߵֿ,źͷ,ȴ*/
+			int sleepers = sleepers_.load(std::memory_order_relaxed);
+			while (sleepers > 0)
+			{
+				if (sleepers_.compare_exchange_weak(sleepers, sleepers - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					return;
+				}
+			}
 		}
+		idle_sem_->WaitForSemSignaled();
 	}
-}
+}
\ No newline at end of file
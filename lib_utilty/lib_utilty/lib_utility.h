@@ -3,26 +3,88 @@
 
 #ifdef _WIN32
 #include <windows.h>
-#include <string>
 #include<process.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#endif
+#include <string>
+#include <iostream>
 #include <assert.h>
 #include <vector>
 #include <list>
 #include <map>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <functional>
+#include "inline_function.h"
+#include "monotonic_clock.h"
+#include "hierarchical_wheel.h"
+#include "timer_heap.h"
+
+#ifndef _WIN32
+/*Windowsƽ̨ṩWindowsͬĻ,ӿڱֲ*/
+typedef int BOOL;
+typedef long LONG;
+typedef double DOUBLE;
+typedef unsigned long DWORD_PTR;
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+#ifndef INFINITE
+#define INFINITE 0xFFFFFFFF
 #endif
 
+inline void Sleep(unsigned long milliseconds)
+{
+	struct timespec ts;
+	ts.tv_sec = milliseconds / 1000;
+	ts.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+	while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+	{
+	}
+}
+#endif // !_WIN32
+
 namespace utility {
 
+#ifdef _WIN32
+typedef HANDLE THREAD_HANDLE;
+#else
+typedef pthread_t THREAD_HANDLE;
+#endif
+
+/*Ĺģʽ
+*MUTEX_DEFAULT:CRITICAL_SECTION/pthread(MULTIPROCESSʱΪں˻),.
+*MUTEX_ADAPTIVE:pauseָָ˱,òʱٹfutex(WindowsΪWaitOnAddress).
+*	ʺٽǳ̵ĳ,,ֻڽʹ(Ķ̻Դģʽ).
+*/
+enum MutexMode { MUTEX_DEFAULT, MUTEX_ADAPTIVE };
+
 class CommonMutex
 {
 public:
-	CommonMutex(std::string mutex_name = "");
+	CommonMutex(std::string mutex_name = "", MutexMode mutex_mode = MUTEX_DEFAULT);
 	~CommonMutex();
 
 	bool LockObject(void);
+	bool TryLockObject(void);//ȴ,òʱfalse
+	bool TimedLockObject(int nMillonSecond);//ȴnMillonSecond
 	bool UnlockObject(void);
 
 private:
+	bool AdaptiveLock(int nMillonSecond);//nMillonSecond<0ʱһֱȴ
+	void AdaptiveUnlock(void);
+
+	MutexMode mutex_mode_;
+	std::atomic<int> lock_state_;//Ӧģʽ״̬:0δ,1Ѽ,2Ѽ߳ڵȴ
+
 #ifdef _WIN32
 /*CRITICAL_SECTIONֻڶ֮߳.
 Ҫڶʹû
@@ -34,6 +96,16 @@ private:
 	std::string mutex_name_;
 	HANDLE mutex_handle_;
 #endif
+#else
+/*Linuxʹÿpthread(CRITICAL_SECTIONһظ).
+MULTIPROCESSָʱ,Ĺڴ,
+ΪPTHREAD_PROCESS_SHAREDPTHREAD_MUTEX_ROBUST.
+Ļ¼źĹڴ(/dev/shm/lib_utility_*)رպȻ,shm_unlinkΪֹ;
+ȨΪ0600,ֻͬһûĽ֮乲
+*/
+	struct PosixMutex;
+	std::string mutex_name_;
+	PosixMutex* mutex_;
 #endif // _WIN32
 };
 
@@ -50,6 +122,11 @@ private:
 	std::string event_name_;
 #ifdef _WIN32
 	HANDLE  event_handle_;
+#else
+	/*ֶλ¼:+(CLOCK_MONOTONIC),
+	ָʱڹڴ,Կʹ*/
+	struct PosixEvent;
+	PosixEvent* event_;
 #endif // _WIN32
 
 };
@@ -69,8 +146,82 @@ private:
 
 #ifdef _WIN32
 	HANDLE semaphore_handle_;
+#else
+	//ź:+(CLOCK_MONOTONIC),ָʱڹڴ
+	struct PosixSemaphore;
+	PosixSemaphore* semaphore_;
+#endif // _WIN32
+
+};
+
+/*д:߿ͬʱй,д߶ռ.
+*prefer_writerΪtrueʱ,дڵȴͲٷµĶ,д߶.
+*WindowsʹSRWLOCK,Linuxʹpthread_rwlock.
+*/
+class CommonRWLock
+{
+public:
+	CommonRWLock(bool prefer_writer = false);
+	~CommonRWLock();
+
+	bool LockShared(void);
+	bool TryLockShared(void);
+	bool UnlockShared(void);
+	bool LockExclusive(void);
+	bool TryLockExclusive(void);
+	bool UnlockExclusive(void);
+
+private:
+	CommonRWLock(const CommonRWLock&);
+	CommonRWLock& operator=(const CommonRWLock&);
+
+	bool prefer_writer_;
+#ifdef _WIN32
+	SRWLOCK rw_lock_;
+	std::atomic<int> waiting_writers_;//SRWLOCKûдȵѡ,Ϲ
+#else
+	pthread_rwlock_t rw_lock_;
 #endif // _WIN32
+};
+
+//:ʱ,ʱ
+class MutexGuard
+{
+public:
+	explicit MutexGuard(CommonMutex& mutex) : mutex_(mutex) { mutex_.LockObject(); }
+	~MutexGuard() { mutex_.UnlockObject(); }
+
+private:
+	MutexGuard(const MutexGuard&);
+	MutexGuard& operator=(const MutexGuard&);
+
+	CommonMutex& mutex_;
+};
+
+class ReadLockGuard
+{
+public:
+	explicit ReadLockGuard(CommonRWLock& rw_lock) : rw_lock_(rw_lock) { rw_lock_.LockShared(); }
+	~ReadLockGuard() { rw_lock_.UnlockShared(); }
+
+private:
+	ReadLockGuard(const ReadLockGuard&);
+	ReadLockGuard& operator=(const ReadLockGuard&);
+
+	CommonRWLock& rw_lock_;
+};
+
+class WriteLockGuard
+{
+public:
+	explicit WriteLockGuard(CommonRWLock& rw_lock) : rw_lock_(rw_lock) { rw_lock_.LockExclusive(); }
+	~WriteLockGuard() { rw_lock_.UnlockExclusive(); }
+
+private:
+	WriteLockGuard(const WriteLockGuard&);
+	WriteLockGuard& operator=(const WriteLockGuard&);
 
+	CommonRWLock& rw_lock_;
 };
 
 template <class T, int DEFAULT_THREAD_COUNT = 10>
@@ -100,7 +251,7 @@ public:
 	BOOL CreateThread(int thread_count = DEFAULT_THREAD_COUNT)
 	{
 		thread_count_ = thread_count;
-		thread_handle_ = new HANDLE[thread_count_];
+		thread_handle_ = new THREAD_HANDLE[thread_count_];
 		thread_params_ = new THREAD_PARAMETERS[thread_count_];
 
 		if (thread_handle_ == NULL || thread_params_ == NULL)
@@ -114,6 +265,7 @@ public:
 			thread_params_[i].result = 0;
 			thread_params_[i].thread_id = i;
 
+#ifdef _WIN32
 			thread_handle_[i] = (HANDLE*)_beginthreadex(NULL,
 				0,
 				(unsigned int(__stdcall *)(void *))ThreadProcessFunc,
@@ -123,13 +275,41 @@ public:
 
 			if (thread_handle_[i] == 0)
 			{
+				thread_count_ = i;//ֻȴѾɹ߳
+				return FALSE;
+			}
+#else
+			if (pthread_create(&thread_handle_[i], NULL, PosixThreadProcessFunc, &thread_params_[i]) != 0)
+			{
+				thread_count_ = i;
 				return FALSE;
 			}
+#endif
 		}
 
 		return TRUE;
 	};
 
+	//ѵthread_index̰߳󶨵core_idCPU
+	BOOL SetThreadAffinity(int thread_index, int core_id)
+	{
+		if (thread_handle_ == NULL || thread_index < 0 || thread_index >= thread_count_ ||
+			core_id < 0 || core_id >= (int)(sizeof(DWORD_PTR) * 8))
+		{
+			return FALSE;
+		}
+#ifdef _WIN32
+		return SetThreadAffinityMask(thread_handle_[thread_index], (DWORD_PTR)1 << core_id) != 0;
+#elif defined(__linux__)
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		CPU_SET(core_id, &cpu_set);
+		return pthread_setaffinity_np(thread_handle_[thread_index], sizeof(cpu_set), &cpu_set) == 0;
+#else
+		return FALSE;
+#endif
+	}
+
 	static void ThreadProcessFunc(void* param)
 	{
 		THREAD_PARAMETERS* thread_param = (THREAD_PARAMETERS*)param;
@@ -140,6 +320,14 @@ public:
 		}
 	}
 
+#ifndef _WIN32
+	static void* PosixThreadProcessFunc(void* param)
+	{
+		ThreadProcessFunc(param);
+		return NULL;
+	}
+#endif
+
 	void DestroyThreads()
 	{
 		OnBeforeThreadExiting();
@@ -150,36 +338,54 @@ public:
 		}
 		WaitThreadsExit();
 
+#ifdef _WIN32
 		for (int i = 0; i < thread_count_; i++)
 		{
-#ifdef _WIN32
 			CloseHandle(thread_handle_[i]);
+		}
 #endif
-			if (thread_handle_ != NULL)
-			{
-				delete[] thread_handle_;
-				thread_handle_ = NULL;
-			}
-			if (thread_params_ != NULL)
-			{
-				delete[] thread_params_;
-				thread_params_ = NULL;
-			}
-
-			thread_count_ = 0;
+		if (thread_handle_ != NULL)
+		{
+			delete[] thread_handle_;
+			thread_handle_ = NULL;
 		}
+		if (thread_params_ != NULL)
+		{
+			delete[] thread_params_;
+			thread_params_ = NULL;
+		}
+
+		thread_count_ = 0;
 	}
 
 private:
 	void WaitThreadsExit()
 	{
 		/*ȴ߳˳ʱ5s,5s̻֮߳δ˳ǿ߳˳*/
+#ifdef _WIN32
 		WaitForMultipleObjects(thread_count_, thread_handle_, TRUE, 5000);
+#else
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += 5;
+		for (int i = 0; i < thread_count_; i++)
+		{
+#if defined(__GLIBC__)
+			if (pthread_timedjoin_np(thread_handle_[i], NULL, &deadline) != 0)
+			{
+				//ʱ̲߳ٵȴ,֮ϵͳ
+				pthread_detach(thread_handle_[i]);
+			}
+#else
+			pthread_join(thread_handle_[i], NULL);
+#endif
+		}
+#endif
 	}
 
 private:
 	int thread_count_;
-	HANDLE* thread_handle_;
+	THREAD_HANDLE* thread_handle_;
 	THREAD_PARAMETERS* thread_params_;
 };
 
@@ -188,9 +394,8 @@ class SystemTime
 public:
 	SystemTime();
 	~SystemTime();
-	unsigned long long GetCurrentMilliseconds();
-private:
-	DOUBLE frequency_;
+	unsigned long long GetCurrentMilliseconds();//ʱ,MonotonicClock
+	unsigned long long GetCurrentNanoseconds();
 };
 
 /***********************************************
@@ -199,21 +404,80 @@ private:
 *ĸֵĴСֱΪ2^6
 *ʱֵС̶ΪTms,ʱֵĶʱΧΪ
 *2^8 * 2^6 * 2^6 * 2^6 * 2^6 * T = 2^32 * T ms
-*0~2^32 * T,ΪTms.
+*0~2^32 * T,ΪTms,ԶĶʱڼʱ·.
+*̶Tڹʱָ(1ms,10ms),
+*ÿ̶ȵĵʱ䰴ʱӵľʱ,صʱۻƯ,
+*ʱ֮߳ͣᲹϴĿ̶.
+*ʱֵļβTimerWheel.
 ************************************************/
 
-#define WHEEL_SCALE 500 //һʱֵһ500ms
-#define WHEEL_BIT1	8
-#define WHEEL_BIT2	6
-#define WHEEL_SIZE1 (1 << WHEEL_BIT1)	//1ʱֵĴС
-#define WHEEL_SIZE2 (1 << WHEEL_BIT2)	//2~5ʱֵĴС
-#define WHEEL_MASK1 (WHEEL_SIZE1 - 1)
-#define WHEEL_MASK2 (WHEEL_SIZE2 - 1)
-#define OFFSET(N) (WHEEL_SIZE1 + (N) * WHEEL_SIZE2)
-#define INDEX(N,M) ((N >> (WHEEL_BIT1 + (M)*WHEEL_BIT2))& WHEEL_MASK2)
+#define WHEEL_SCALE 500 //һʱһĬֵ500ms
 
 
-//ʱ֪ͨ
+/*.
+*ڴ水Ӵ(slab)г,ֻڳʱ黹ϵͳ,ԿͷеĴͷ֮Ȼ԰ȫȡ.
+*ÿ̻߳һп,˻˲żȫֿ.
+*ÿһ:32λǴ,32λ±.ͷʱ1,ɾ漴ʧЧ.
+*/
+class FixedSizePool
+{
+public:
+	FixedSizePool(size_t block_size);
+	~FixedSizePool();
+
+	void* Allocate();//غľʱNULL
+	void Deallocate(void* block);
+	unsigned long long GetHandle(void* block);
+	void* GetBlock(unsigned long long handle);//ʧЧʱNULL
+	size_t GetBlockSize() const;
+
+	//С󰴴Сּʹùĳ,󼶱ʱʹϵͳ
+	static void* AllocateSmall(size_t size);
+	static void DeallocateSmall(void* block, size_t size);
+
+private:
+	FixedSizePool(const FixedSizePool&);
+	FixedSizePool& operator=(const FixedSizePool&);
+
+	enum { SLAB_SHIFT = 10, SLAB_BLOCKS = 1 << SLAB_SHIFT, MAX_SLABS = 16384, CACHE_SIZE = 64, MAX_POOLS = 16 };
+
+	struct BlockHeader
+	{
+		unsigned index;
+		std::atomic<unsigned> generation;
+		unsigned long long reserved;//ʹݲְ16ֽڶ
+	};
+
+	//߳˳ʱѻĿп黹ȫֿ
+	struct ThreadCache
+	{
+		ThreadCache() : pool(NULL), count(0) {}
+		~ThreadCache();
+
+		FixedSizePool* pool;
+		int count;
+		unsigned items[CACHE_SIZE];
+	};
+
+	BlockHeader* GetHeader(unsigned index);
+	int FetchBatch(unsigned* items, int count);
+	void ReleaseBatch(const unsigned* items, int count);
+	ThreadCache* GetThreadCache();
+	static FixedSizePool* GetSmallPool(size_t size);
+
+	size_t block_size_;
+	size_t stride_;//ͷݲֵĴС
+	int pool_id_;//̻߳еλ,MAX_POOLSĳزʹ̻߳
+	std::atomic<char*>* slabs_;
+	unsigned slab_count_;
+	std::vector<unsigned> free_list_;
+	CommonMutex mutex_;
+
+	static std::atomic<int> pool_count_;
+	static thread_local ThreadCache thread_caches_[MAX_POOLS];
+};
+
+//ʱ֪ͨ.Ӷط,ɶʱͷ
 class TimerNotify
 {
 public:
@@ -221,73 +485,1059 @@ public:
 	virtual ~TimerNotify() {};
 	virtual void OnTimerNotify() = 0;
 
+	static void* operator new(size_t size) { return FixedSizePool::AllocateSmall(size); }
+	static void operator delete(void* block, size_t size) { FixedSizePool::DeallocateSmall(block, size); }
 };
 
+//ʱص:lambdaȿɵöֱӴڶʱ,48ֽʱڴ
+typedef InlineFunction<48> TimerCallback;
+
+//ʱ:32λǴ,32λڶе±,0ʾЧ.
+//ʱֹ֮ͣʧЧ,StopATimerȽӿڲκ
+typedef unsigned long long TimerHandle;
+
 enum TimerType { ONCE, CIRCLE };
 
-//ʱ
-class TimerTask
+class TimerThread;
+class TimerDispatcher;
+
+//ʱ,ڿ̶ȱʱֽڵ.
+//̶ȳTimerManagerʱָ,TickNsֻڰʱĽӿ,TimerManagerʹ
+typedef TimerWheel<1000000ULL, 8, 6, 4> TimerTaskWheel;
+
+class TimerTask : public TimerWheelHook
 {
 public:
 
 	TimerTask();
 	~TimerTask();
 	void SetTimerTask(TimerNotify* timer_notify, unsigned interval, TimerType timer_type = CIRCLE);
+	void SetTimerCallback(TimerCallback&& timer_callback);
 
 	unsigned GetIntervalTime();
+	void SetIntervalTime(unsigned interval);
 	void SetVectorIndex(int vect_index);
 	int GetVectorIndex(void);
-	void HandleTask();
+	void SetRegistryIndex(int registry_index);
+	int GetRegistryIndex(void);
+	//dispatcherΪNULLʱصִ߳,ڵǰִ߳
+	void HandleTask(TimerDispatcher* dispatcher = NULL);
+	void RunCallback();
+	void SetOwner(TimerThread* owner);
+	TimerThread* GetOwner(void);
+	void SetExpireTick(unsigned long long expire_tick);
+	unsigned long long GetExpireTick(void);
+	TimerType GetTimerType(void);
+	TimerHandle GetHandle(void);
+
+	//״̬,TimerManager::PostponeTimer
+	void InitLazyState(void);//Ͷ֮ǰ,¼Ĵ
+	unsigned long long GetLazyState(void);
+	bool CompareExchangeLazyState(unsigned long long& expected, unsigned long long desired);
+
+	/*ַ:߳ʱ1,ִ1.
+	*ʱֹ߳ͣʱReleaseTask,ŶӻִʱһɵĹ֪߳ͨʱ߳ͷ*/
+	void AddDispatchRef(void);
+	bool ReleaseDispatchRef(void);//trueʱ÷ͷ
+	bool ReleaseTask(void);//trueʱ÷ͷ
+	bool IsDispatching(void);
+
+	//ʧЧʱNULL.ֻĶʱ߳̿ʹ÷ص,ֻ߳ܶȡ߳
+	static TimerTask* FromHandle(TimerHandle handle);
+
+	static void* operator new(size_t size);
+	static void operator delete(void* block);
 
-	std::list<TimerTask*>::iterator itr_;
 private:
+	static FixedSizePool& GetPool();
+
+	enum { DISPATCH_RELEASED = 0x80000000u, DISPATCH_COUNT_MASK = 0x7FFFFFFFu };
+
+	std::atomic<TimerThread*> owner_;//Ķʱ߳
+	std::atomic<unsigned long long> lazy_state_;
+	std::atomic<unsigned> dispatch_state_;//31λǷַ,λʾѾֹͣ
 	unsigned interval_time_;
 	int vect_index_;
+	int registry_index_;//ʱ̵߳еλ,δǼʱΪ-1
 	TimerNotify* timer_notify_;
+	TimerCallback timer_callback_;//ûtimer_notify_ʱ
 	TimerType timer_type_;
 
 };
 
+/*ʱеѡ.
+*TIMER_QUEUE_WHEEL:ֲʱ,̶ȴ,ӺֹͣO(1),ʺϴʱ;
+*TIMER_QUEUE_HEAP:4С,뾫ȷ,̶ܿȳӰ,ӺֹͣO(log n),ûй̶Ĳ;
+*TIMER_QUEUE_AUTO:ԤƵĶʱѡ,HEAP_MAX_TIMERSʱö,δ֪(0)ʱʱ.
+*/
+enum TimerQueuePolicy { TIMER_QUEUE_AUTO, TIMER_QUEUE_WHEEL, TIMER_QUEUE_HEAP };
+
 //ʱ
 class TimerManager
 {
 public:
-	TimerManager();
+	/*Ѻʱֵķֽ,ȡtimer_benchmarkcold_heap_crossover_timers:
+	*/ֹͣ/ڻϲ,ʱʱѲʱ.
+	*x86-64ϻȵʱΪ0,ÿβ֮L1/L2Ϊ64:ʱٵʱֻм,
+	*ʱҪʲλͼ.ʱ߳λ֮ͨᴦ,ȡĽ*/
+	enum { HEAP_MAX_TIMERS = 64 };
+
+	TimerManager(unsigned tick_ms = WHEEL_SCALE);
 	~TimerManager();
 
-	void AddTimer(TimerTask* timer);
+	/*Ӷʱ֮ǰ,Ѿжʱʱfalse.
+	*ʹöʱʱ侫ȷ1ms,ǰĵʱȴ,̶ٰȻ*/
+	bool SetQueuePolicy(TimerQueuePolicy policy, unsigned expected_timers = 0);
+	static TimerQueuePolicy SelectQueue(TimerQueuePolicy policy, unsigned expected_timers);//WHEELHEAP
+	bool IsHeapQueue(void);
+	unsigned GetTimerCount(void);//ڵȴڵĶʱ
+
+	void AddTimer(TimerTask* timer);//ӵǰʱ俪ʼ㵽ڿ̶
 	void RemoveTimer(TimerTask* timer);
-	int Cascade(int offset, int index);
-	void DetectTimers(void);
+	void RescheduleTimer(TimerTask* timer, unsigned interval);//µļ·ʱ,O(1)
+	unsigned long long CalcExpireTick(unsigned interval);//ӵǰʱ俪ʼinterval֮Ŀ̶,̵߳
+	/*ƺʱ,̵߳:ֻ¼µĵڿ̶,ԭĲ,
+	*ڻʱ̶ֿƺ·ʱ.
+	*ʧЧʱԲtrue;ûڵȴڡµĿ̶ȸ̫Զʱfalse,Ҫ.*/
+	bool PostponeTimer(TimerTask* timer, unsigned generation, unsigned interval);
+	//:ֻһʱ,۷ÿһƴӵ
+	void AddTimers(TimerTask** timers, int count);
+	void RemoveTimers(TimerTask** timers, int count);
+	void DetectTimers(void);//ѾڵĿ̶,
+	unsigned GetWaitTime(void);//һҪĿ̶ȵĺ,ûжʱʱINFINITE
+	unsigned GetTickInterval(void);
+	/*޿̶ģʽ:GetWaitTimeķǿղ(ҪĲ)ĵʱ,
+	*رʱÿ̶ȶһ.Ĭϴ*/
+	void SetTicklessMode(bool tickless);
+	void SetDispatcher(TimerDispatcher* dispatcher);//ΪNULLʱصڶʱִ߳
+	bool GetNextPendingTick(unsigned long long* next_tick);//һҪĿ̶,òλͼ
+
 private:
-	typedef std::list<TimerTask*> TIMER_LIST;
-	std::vector<TIMER_LIST> timer_wheel_;
-	unsigned current_pos_;
+	//ʱּ͵ʱĻص
+	struct WheelHandler
+	{
+		TimerManager* manager;
+		unsigned long long now_tick;//δĿ̶,ǰʱڵĿ̶
+		void OnCascade(TimerWheelHook* node);
+		void OnExpire(TimerWheelHook* node);
+	};
+
+	void InsertTimer(TimerTask* timer);//timerĵڿ̶ȷʱ
+	/*ѵڿ̶ȷ״̬:32λǴ,31λʾԶƺ,31λǵڿ̶.
+	*keep_laterΪtrueʱ߳Ѿƺ˿̶,ƺĿ̶*/
+	void PublishExpireTick(TimerTask* timer, bool keep_later);
+	unsigned long long GetLazyExpireTick(TimerTask* timer);//ڵǰĵڿ̶
+	bool DisarmBeforeFire(TimerTask* timer);//ʱ䱻ƺʱµڿ̶Ȳfalse
+	static int LazyTickDiff(unsigned tick1, unsigned tick2);//31λ̶ȰƱȽ
+	unsigned long long GetCurrentTick(void);
+	unsigned long long GetQueueTick(void);//һҪĿ̶
+	unsigned long long DeadlineToTick(unsigned long long now_ns, unsigned interval);
+	unsigned long long IntervalToTicks(unsigned interval);
+	bool IsQueued(TimerTask* timer);
+
+	enum { LAZY_ARMED = 0x80000000u, LAZY_TICK_MASK = 0x7FFFFFFFu, LAZY_WINDOW = 1u << 29 };
+
+	TimerManager(const TimerManager&);
+	TimerManager& operator=(const TimerManager&);
+
+	//ֻѡеĶ,һΪNULL
+	TimerTaskWheel* timer_wheel_;
+	TimerHeap* timer_heap_;
+	bool use_heap_;
+	unsigned long long start_time_;//0̶ȶӦĵʱʱ(ms)
+	unsigned tick_ms_;//ʹöʱΪ1
+	unsigned wheel_tick_ms_;//ʱָʱ̶ֿ
+	bool tickless_;
+	TimerDispatcher* dispatcher_;
+	SystemTime system_time_;
+};
+
+//ʱ߳:÷ֻ߳Ͷ,ʱֻɶʱ߳޸
+enum TimerCommandType { TIMER_CMD_ADD, TIMER_CMD_CANCEL, TIMER_CMD_RESCHEDULE, TIMER_CMD_ADD_BATCH, TIMER_CMD_CANCEL_BATCH, TIMER_CMD_RELEASE };
+
+struct TimerCommand
+{
+	std::atomic<TimerCommand*> next_;
+	TimerCommandType cmd_type_;
+	TimerTask* timer_task_;//ֻTIMER_CMD_ADDTIMER_CMD_RELEASE
+	TimerHandle timer_handle_;
+	unsigned interval_time_;
+	TimerTask** batch_tasks_;//TIMER_CMD_ADD_BATCH,ɶʱ߳ͷ
+	TimerHandle* batch_handles_;//TIMER_CMD_CANCEL_BATCH,ɶʱ߳ͷ
+	int batch_count_;
+
+	static void* operator new(size_t size) { return FixedSizePool::AllocateSmall(size); }
+	static void operator delete(void* block, size_t size) { FixedSizePool::DeallocateSmall(block, size); }
+};
+
+/*ߵ(Vyukov㷨).
+*Push̵߳,ֻһԭӽ,;
+*Popֻڶʱ̵߳.
+*/
+class TimerCommandQueue
+{
+public:
+	TimerCommandQueue();
+	~TimerCommandQueue();
+
+	void Push(TimerCommand* command);
+	TimerCommand* Pop();
+
+private:
+	TimerCommandQueue(const TimerCommandQueue&);
+	TimerCommandQueue& operator=(const TimerCommandQueue&);
+
+	std::atomic<TimerCommand*> head_;//߶
+	char pad_[64];//head_tail_ڲͬĻ,α
+	TimerCommand* tail_;//߶
+	TimerCommand stub_;
+};
+
+//öʱʱÿʱĲ
+struct TimerSetting
+{
+	TimerNotify* timer_notify;
+	unsigned interval_time;
+	TimerType timer_type;
 };
 
 //ʱ߳
 class TimerThread: public utility::MultiThreads<TimerThread,1>
 {
 public:
-	TimerThread();
+	TimerThread(unsigned tick_ms = WHEEL_SCALE);
 	~TimerThread();
 	 
 	void ThreadWorkFunc(THREAD_PARAMETERS* work_para);
 	void OnBeforeThreadExiting();
 
-	BOOL StartTimerThread();//ʱ߳
+	BOOL StartTimerThread(int core_id = -1);//ʱ߳,core_id>=0ʱ󶨵CPU
 	void StopTimerThread();//ֹͣʱ߳
 
-	//һʱ
-	TimerTask* SetATimer(TimerNotify* timer_notify, unsigned interval_time, TimerType timeType = CIRCLE);
-	void StopATimer(TimerTask* timer_task);//ֹͣһʱ
+	//һʱ,ʧʱ0
+	TimerHandle SetATimer(TimerNotify* timer_notify, unsigned interval_time, TimerType timeType = CIRCLE);
+	//Կɵö(lambda)Ϊصöʱ
+	template <class F>
+	TimerHandle SetATimer(F&& func, unsigned interval_time, TimerType timeType = CIRCLE,
+		typename std::enable_if<!std::is_convertible<F, TimerNotify*>::value>::type* = 0)
+	{
+		if (interval_time >= 0xFFFFFFFFUL)
+		{
+			return 0;
+		}
+		TimerTask* timer_task = new TimerTask();
+		timer_task->SetTimerCallback(TimerCallback(std::forward<F>(func)));
+		timer_task->SetTimerTask(NULL, interval_time, timeType);
+		return ArmTimerTask(timer_task, interval_time);
+	}
+	void StopATimer(TimerHandle timer_handle);//ֹͣһʱ,֮ʧЧ
+	/*µļöʱ.
+	*lazyΪtrueµĵʱ䲻ԭĵʱʱ,ֻڵ̸߳µڿ̶,ͶҲѶʱ߳,
+	*ʺÿյһƺĿгʱ;ʱֻƺһε,ѭʱڲ.*/
+	void RescheduleTimer(TimerHandle timer_handle, unsigned interval_time, bool lazy = false);
+	/*öʱ,ֻͶһһζʱ߳.
+	*timer_handles[i]صiʱľ,ЧʱΪ0;سɹĸ,settingstimer_handlesΪNULLʱ0*/
+	int SetTimers(const TimerSetting* settings, int count, TimerHandle* timer_handles);
+	void StopTimers(const TimerHandle* timer_handles, int count);//ֹͣ,Чľ
+	void SetTicklessMode(bool tickless);//֮߳ǰ
+	//֮߳ǰ,TimerManager::SetQueuePolicy
+	bool SetQueuePolicy(TimerQueuePolicy policy, unsigned expected_timers = 0);
+	/*֮߳ǰ.thread_count>0ʱʱֻ߳ռڵ,thread_countִ߳лص,
+	*ĻصƳʱ.ͬһʱĸλصڲͬĹִ߳;
+	*ѭʱһεĻصŶӻִʱһ,Ļصص.ζʱ*/
+	void SetDispatchThreads(int thread_count);
+	unsigned long long GetWakeupCount();//ʱ̱߳ѵĴ
+	unsigned GetTimerCount();//ʱ߳лûֹͣĶʱ
 	
 private:
+	friend class TimerDispatcher;
+
+	TimerHandle ArmTimerTask(TimerTask* timer_task, unsigned interval_time);
+	void PostCommand(TimerCommandType cmd_type, TimerTask* timer_task, TimerHandle timer_handle, unsigned interval_time);
+	TimerTask* FindOwnTask(TimerHandle timer_handle);//ֻڶʱ߳е
+	void ProcessCommands();//ֻڶʱ߳е
+	void ProcessBatchCommand(TimerCommand* command);
+	//ǼǺעO(1):עʱһƵճλ
+	void RegisterTask(TimerTask* timer_task);
+	void UnregisterTask(TimerTask* timer_task);
+	void DeleteTask(TimerTask* timer_task);//ڷַȹִ߳ͷ
+	void ClearTasks();
+
 	TimerManager timer_manager_;
-	std::list<TimerTask*> task_list_;
-	BOOL exit_flag_;
+	TimerDispatcher* dispatcher_;
+	int dispatch_threads_;
+	std::vector<TimerTask*> task_table_;//ֻڶʱ߳з
+	std::atomic<unsigned> timer_count_;
+	TimerCommandQueue command_queue_;
+	std::atomic<BOOL> exit_flag_;
+	std::atomic<unsigned long long> wakeup_count_;
+	BOOL time_period_set_;//Ƿϵͳʱ(timeBeginPeriod)
 	utility::CommonEvent comm_event_;
 };
 
+/***********************************************
+*Ƭʱ:Nʱ߳,ÿ߳ӵԼʱ,
+*԰ÿ̰߳󶨵һCPU.
+*ʱ̻߳߰key䵽Ƭ,
+*ֹͣ/趨ʱ̵߳,תʱķƬ.
+************************************************/
+class ShardedTimerService
+{
+public:
+	ShardedTimerService();
+	~ShardedTimerService();
+
+	//shard_count<=0ʱʹCPU,tick_msÿƬʱֵĿ̶
+	BOOL StartService(int shard_count = 0, bool bind_core = false, unsigned tick_ms = WHEEL_SCALE);
+	void StopService();
+	int GetShardCount();
+
+	//߳ѡƬ,ͬһ߳õĶʱͬһƬ
+	TimerHandle SetATimer(TimerNotify* timer_notify, unsigned interval_time, TimerType timeType = CIRCLE);
+	//keyѡƬ,ͬkeyĶʱͬһƬ
+	TimerHandle SetATimerByKey(unsigned long long key, TimerNotify* timer_notify, unsigned interval_time, TimerType timeType = CIRCLE);
+
+	template <class F>
+	TimerHandle SetATimer(F&& func, unsigned interval_time, TimerType timeType = CIRCLE,
+		typename std::enable_if<!std::is_convertible<F, TimerNotify*>::value>::type* = 0)
+	{
+		if (shards_.empty())
+		{
+			return 0;
+		}
+		return shards_[SelectShardByThread()]->SetATimer(std::forward<F>(func), interval_time, timeType);
+	}
+
+	template <class F>
+	TimerHandle SetATimerByKey(unsigned long long key, F&& func, unsigned interval_time, TimerType timeType = CIRCLE,
+		typename std::enable_if<!std::is_convertible<F, TimerNotify*>::value>::type* = 0)
+	{
+		if (shards_.empty())
+		{
+			return 0;
+		}
+		return shards_[SelectShardByKey(key)]->SetATimer(std::forward<F>(func), interval_time, timeType);
+	}
+
+	void StopATimer(TimerHandle timer_handle);
+	void RescheduleTimer(TimerHandle timer_handle, unsigned interval_time, bool lazy = false);
+	//ͬһʱڵ̶߳ӦķƬ;ֹͣʱƬ,ÿƬһ
+	int SetTimers(const TimerSetting* settings, int count, TimerHandle* timer_handles);
+	void StopTimers(const TimerHandle* timer_handles, int count);
+
+private:
+	ShardedTimerService(const ShardedTimerService&);
+	ShardedTimerService& operator=(const ShardedTimerService&);
+
+	int SelectShardByThread();
+	int SelectShardByKey(unsigned long long key);
+
+	std::vector<TimerThread*> shards_;
+};
+
+//̳߳:next_ֻͶݶʹ
+struct PoolTask
+{
+	PoolTask() : next_(NULL) {}
+	virtual ~PoolTask() {}
+	virtual void Run() {}
+	//ִ֮ͷ.ⲿ(ǶЭ֡еĵȴ)д,ͷԼ
+	virtual void Execute() { Run(); delete this; }
+	virtual void Discard() { delete this; }//ֹ̳߳ͣʱûִ
+
+	std::atomic<PoolTask*> next_;
+};
+
+//ѷֵ쳣promise,void
+template <class R>
+struct PromiseSetter
+{
+	template <class F>
+	static void Set(std::promise<R>& promise, F& func) { promise.set_value(func()); }
+};
+
+template <>
+struct PromiseSetter<void>
+{
+	template <class F>
+	static void Set(std::promise<void>& promise, F& func) { func(); promise.set_value(); }
+};
+
+/*Submitύ:ɵöInlineFunction,48ֽʱڴ,
+*ֻƶĿɵöҲύ;ͨpromise_÷future*/
+template <class R>
+struct PackagedPoolTask : public PoolTask
+{
+	template <class F>
+	explicit PackagedPoolTask(F&& func) : func_(Call<typename std::decay<F>::type>(std::forward<F>(func), &promise_)) {}
+	void Run() { func_(); }
+
+	template <class F>
+	struct Call
+	{
+		template <class G>
+		Call(G&& func, std::promise<R>* promise) : func_(std::forward<G>(func)), promise_(promise) {}
+		void operator()()
+		{
+			try
+			{
+				PromiseSetter<R>::Set(*promise_, func_);
+			}
+			catch (...)
+			{
+				promise_->set_exception(std::current_exception());
+			}
+		}
+
+		F func_;
+		std::promise<R>* promise_;
+	};
+
+	std::promise<R> promise_;
+	InlineFunction<48> func_;
+};
+
+/*Chase-Levȡ˫˶(Le˵C11ڴ汾).
+*Push/Pop̵ֻ߳,bottom_˲;
+*Steal̵߳,top_CASȡ.
+*˻,ܻڱȡ߶ȡ,ʱͷ.
+*/
+class WorkStealingDeque
+{
+public:
+	WorkStealingDeque(int capacity = 256);
+	~WorkStealingDeque();
+
+	void Push(PoolTask* task);
+	PoolTask* Pop();
+	PoolTask* Steal();
+	bool IsEmpty() const;
+
+private:
+	WorkStealingDeque(const WorkStealingDeque&);
+	WorkStealingDeque& operator=(const WorkStealingDeque&);
+
+	struct TaskArray
+	{
+		long long capacity;//2
+		std::atomic<PoolTask*>* buffer;
+	};
+	TaskArray* GrowArray(TaskArray* array, long long bottom, long long top);
+
+	std::atomic<long long> top_;//ȡ
+	char pad_[64];
+	std::atomic<long long> bottom_;//̶߳
+	std::atomic<TaskArray*> array_;
+	std::vector<TaskArray*> retired_arrays_;
+};
+
+//ⲿ߳߳ͶĶߵ,ͬTimerCommandQueue
+class PoolTaskQueue
+{
+public:
+	PoolTaskQueue();
+	~PoolTaskQueue();
+
+	void Push(PoolTask* task);
+	PoolTask* Pop();
+
+private:
+	PoolTaskQueue(const PoolTaskQueue&);
+	PoolTaskQueue& operator=(const PoolTaskQueue&);
+
+	std::atomic<PoolTask*> head_;
+	char pad_[64];
+	PoolTask* tail_;
+	PoolTask stub_;
+};
+
+/*ȡ̳߳.
+*ÿ߳һChase-Lev,߳ύֱѹԼĶ;
+*ⲿ߳ύͶݵ̵߳ռ.
+*߳̿ʱȡԼĶкռ,ѡ߳ȡ,
+*ȡ̵߳ռ,û˯.
+*ݹڹ߳WaitForȴ,ȴڼִ,ռס߳.
+*/
+class ThreadPool : public utility::MultiThreads<ThreadPool, 4>
+{
+public:
+	ThreadPool();
+	~ThreadPool();
+
+	//thread_count<=0ʱʹCPU
+	BOOL StartPool(int thread_count = 0);
+	void StopPool();
+	int GetThreadCount();
+
+	//ύһ޲Ŀɵö,lambda;صfutureõķֵ쳣
+	template <class F>
+	std::future<decltype(std::declval<typename std::decay<F>::type&>()())> Submit(F&& func)
+	{
+		typedef decltype(std::declval<typename std::decay<F>::type&>()()) R;
+		PackagedPoolTask<R>* task = new PackagedPoolTask<R>(std::forward<F>(func));
+		std::future<R> result = task->promise_.get_future();
+		PushTask(task);
+		return result;
+	}
+
+	//Ͷһ,ִʱtask->Execute();̳߳ûʱڵֱִ߳
+	void PostTask(PoolTask* task);
+
+	//ȴfuture;ڹ߳еʱ,ȴڼִ
+	template <class R>
+	R WaitFor(std::future<R>& result)
+	{
+		while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!HelpOnce())
+			{
+				if (current_pool_ != this)
+				{
+					result.wait();
+					break;
+				}
+				std::this_thread::yield();
+			}
+		}
+		return result.get();
+	}
+
+	void ThreadWorkFunc(THREAD_PARAMETERS* work_para);
+	void OnBeforeThreadExiting();
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	struct PoolWorker
+	{
+		WorkStealingDeque deque_;
+		PoolTaskQueue inbox_;
+		std::atomic<bool> inbox_busy_;//߳ȡռ
+		unsigned random_seed_;
+		char pad_[64];
+	};
+
+	void PushTask(PoolTask* task);
+	PoolTask* FindTask(int worker_index);
+	PoolTask* TakeInbox(PoolWorker* owner, PoolWorker* self);
+	bool HelpOnce();
+	bool HasPendingTask();
+	void WakeWorker();
+	void ParkWorker();
+
+	std::vector<PoolWorker*> workers_;
+	std::atomic<unsigned> submit_sequence_;//ⲿύѡ߳
+	std::atomic<int> inbox_tasks_;//ռе
+	std::atomic<int> sleepers_;//˯߻׼˯ߵĹ߳
+	std::atomic<bool> exit_flag_;
+	CommonSemaphore* idle_sem_;
+
+	static thread_local ThreadPool* current_pool_;
+	static thread_local int current_worker_;
+};
+
+/*ߵ߻ζ,޵ȴ.
+*CAPACITY2,±ɵ,ȡ.
+*Push/PushBatch/Back̵ֻ߳,Pop/PopBatch/Front/Clear̵ֻ߳.
+*˫ԻԷ±,ֻлʾʱȥԷĻ.
+*/
+template <class T, int CAPACITY = 1024>
+class CycleQueue
+{
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of 2");
+	enum { MASK = CAPACITY - 1 };
+
+public:
+	CycleQueue() : head_(0), cached_tail_(0), tail_(0), cached_head_(0) {}
+	~CycleQueue() {}
+
+	bool Push(const T& value)
+	{
+		unsigned tail = tail_.load(std::memory_order_relaxed);
+		if (tail - cached_head_ == CAPACITY)
+		{
+			cached_head_ = head_.load(std::memory_order_acquire);
+			if (tail - cached_head_ == CAPACITY)
+			{
+				return false;//
+			}
+		}
+		buffer_[tail & MASK] = value;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//ʵʷĸ
+	int PushBatch(const T* values, int count)
+	{
+		unsigned tail = tail_.load(std::memory_order_relaxed);
+		if (CAPACITY - (tail - cached_head_) < (unsigned)count)
+		{
+			cached_head_ = head_.load(std::memory_order_acquire);
+		}
+		unsigned free_count = CAPACITY - (tail - cached_head_);
+		if ((unsigned)count > free_count)
+		{
+			count = (int)free_count;
+		}
+		for (int i = 0; i < count; i++)
+		{
+			buffer_[(tail + i) & MASK] = values[i];
+		}
+		tail_.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	bool Pop(T& value)
+	{
+		unsigned head = head_.load(std::memory_order_relaxed);
+		if (head == cached_tail_)
+		{
+			cached_tail_ = tail_.load(std::memory_order_acquire);
+			if (head == cached_tail_)
+			{
+				return false;//п
+			}
+		}
+		value = buffer_[head & MASK];
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop()
+	{
+		T value;
+		return Pop(value);
+	}
+
+	//ʵȡĸ
+	int PopBatch(T* values, int max_count)
+	{
+		unsigned head = head_.load(std::memory_order_relaxed);
+		if (cached_tail_ - head < (unsigned)max_count)
+		{
+			cached_tail_ = tail_.load(std::memory_order_acquire);
+		}
+		unsigned count = cached_tail_ - head;
+		if (count > (unsigned)max_count)
+		{
+			count = (unsigned)max_count;
+		}
+		for (unsigned i = 0; i < count; i++)
+		{
+			values[i] = buffer_[(head + i) & MASK];
+		}
+		head_.store(head + count, std::memory_order_release);
+		return (int)count;
+	}
+
+	//зǿʱܵ
+	T& Front() { return buffer_[head_.load(std::memory_order_relaxed) & MASK]; }
+	T& Back() { return buffer_[(tail_.load(std::memory_order_relaxed) - 1) & MASK]; }
+
+	bool IsEmpty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+	int GetSize() const { return (int)(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire)); }
+	int GetCapacity() const { return CAPACITY; }
+
+	void Clear()
+	{
+		head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	CycleQueue(const CycleQueue&);
+	CycleQueue& operator=(const CycleQueue&);
+
+	//ʹõ±ʹõ±ڲͬĻ
+	char pad0_[64];
+	std::atomic<unsigned> head_;
+	unsigned cached_tail_;
+	char pad1_[64];
+	std::atomic<unsigned> tail_;
+	unsigned cached_head_;
+	char pad2_[64];
+	T buffer_[CAPACITY];
+};
+
+/*߶н绷ζ(Vyukov㷨).
+*ÿ۴һ:ŵ±ʾۿ,±+1ʾ.
+*ߺ߸CAS±,;һCASĶ.
+*/
+template <class T, int CAPACITY = 1024>
+class MpmcCycleQueue
+{
+	static_assert(CAPACITY > 1 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of 2");
+	enum { MASK = CAPACITY - 1 };
+
+public:
+	MpmcCycleQueue() : enqueue_pos_(0), dequeue_pos_(0)
+	{
+		for (unsigned i = 0; i < (unsigned)CAPACITY; i++)
+		{
+			buffer_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	~MpmcCycleQueue() {}
+
+	bool Push(const T& value)
+	{
+		return PushBatch(&value, 1) == 1;
+	}
+
+	bool Pop(T& value)
+	{
+		return PopBatch(&value, 1) == 1;
+	}
+
+	//ʵʷĸ
+	int PushBatch(const T* values, int count)
+	{
+		unsigned pos = enqueue_pos_.load(std::memory_order_relaxed);
+		unsigned claimed = 0;
+		for (;;)
+		{
+			/*posʼеĲ*/
+			claimed = 0;
+			while (claimed < (unsigned)count)
+			{
+				unsigned seq = buffer_[(pos + claimed) & MASK].sequence.load(std::memory_order_acquire);
+				if (seq != pos + claimed)
+				{
+					break;
+				}
+				claimed++;
+			}
+			if (claimed == 0)
+			{
+				unsigned seq = buffer_[pos & MASK].sequence.load(std::memory_order_acquire);
+				if ((int)(seq - pos) < 0)
+				{
+					return 0;//
+				}
+				pos = enqueue_pos_.load(std::memory_order_relaxed);//
+				continue;
+			}
+			if (enqueue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+
+		for (unsigned i = 0; i < claimed; i++)
+		{
+			Cell& cell = buffer_[(pos + i) & MASK];
+			cell.data = values[i];
+			cell.sequence.store(pos + i + 1, std::memory_order_release);
+		}
+		return (int)claimed;
+	}
+
+	//ʵȡĸ
+	int PopBatch(T* values, int max_count)
+	{
+		unsigned pos = dequeue_pos_.load(std::memory_order_relaxed);
+		unsigned claimed = 0;
+		for (;;)
+		{
+			claimed = 0;
+			while (claimed < (unsigned)max_count)
+			{
+				unsigned seq = buffer_[(pos + claimed) & MASK].sequence.load(std::memory_order_acquire);
+				if (seq != pos + claimed + 1)
+				{
+					break;
+				}
+				claimed++;
+			}
+			if (claimed == 0)
+			{
+				unsigned seq = buffer_[pos & MASK].sequence.load(std::memory_order_acquire);
+				if ((int)(seq - (pos + 1)) < 0)
+				{
+					return 0;//п
+				}
+				pos = dequeue_pos_.load(std::memory_order_relaxed);
+				continue;
+			}
+			if (dequeue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+
+		for (unsigned i = 0; i < claimed; i++)
+		{
+			Cell& cell = buffer_[(pos + i) & MASK];
+			values[i] = cell.data;
+			cell.sequence.store(pos + i + CAPACITY, std::memory_order_release);
+		}
+		return (int)claimed;
+	}
+
+	//ʱֻǽֵ
+	bool IsEmpty() const { return GetSize() <= 0; }
+	int GetSize() const
+	{
+		int size = (int)(enqueue_pos_.load(std::memory_order_acquire) - dequeue_pos_.load(std::memory_order_acquire));
+		return size > 0 ? size : 0;
+	}
+	int GetCapacity() const { return CAPACITY; }
+
+private:
+	MpmcCycleQueue(const MpmcCycleQueue&);
+	MpmcCycleQueue& operator=(const MpmcCycleQueue&);
+
+	struct Cell
+	{
+		std::atomic<unsigned> sequence;
+		T data;
+	};
+
+	char pad0_[64];
+	Cell buffer_[CAPACITY];
+	char pad1_[64];
+	std::atomic<unsigned> enqueue_pos_;
+	char pad2_[64];
+	std::atomic<unsigned> dequeue_pos_;
+	char pad3_[64];
+};
+
+/*ʱصĹ߳.
+*ʱ̵߳Dispatchռڵ,һ̶ֿ֮Flushһη빲,軽ѿеĹ߳.
+*߳ÿֻȡһ,Ļصֻռסһ߳,̼߳ȡе.
+*ͬһһλص֮ǰٴη,صص.ʱʱ̵߳ȴ߳ڳλ.
+*/
+class TimerDispatcher : public MultiThreads<TimerDispatcher, 4>
+{
+public:
+	TimerDispatcher();
+	~TimerDispatcher();
+
+	BOOL StartDispatcher(int thread_count);
+	void StopDispatcher();//ŶӵĻصִ
+	int GetThreadCount();
+
+	void Dispatch(TimerTask* timer_task);//ֻڶʱ߳е
+	//ֻڶʱ߳е,ʱȴ,falseʾеζʱĻص´Ͷ
+	bool Flush();
+
+	void ThreadWorkFunc(THREAD_PARAMETERS* work_para);
+	void OnBeforeThreadExiting();
+
+private:
+	TimerDispatcher(const TimerDispatcher&);
+	TimerDispatcher& operator=(const TimerDispatcher&);
+
+	enum { QUEUE_CAPACITY = 4096 };
+
+	void WakeWorkers(int count);
+	void ParkWorker();
+	static void FinishTask(TimerTask* timer_task);//Ѿֹͣ񽻸Ķʱ߳ͷ
+
+	MpmcCycleQueue<TimerTask*, QUEUE_CAPACITY> queue_;
+	std::vector<TimerTask*> batch_;//ռ,ֻɶʱ̷߳
+	int worker_count_;
+	std::atomic<int> sleepers_;
+	std::atomic<bool> exit_flag_;
+	CommonSemaphore* idle_sem_;
+};
+
+/*˫.ڵһĽڵ,32λ±ָ,ɾĽڵŻرĿ.
+*NODE_CAPACITY>1ʱչ:ÿڵŶԪ,FindNodeڴɨ.
+*±0ڱڵ,β.
+*/
+template <class T, int NODE_CAPACITY = 1>
+class DoubleLinkedList
+{
+	static_assert(NODE_CAPACITY > 0, "NODE_CAPACITY must be positive");
+
+public:
+	DoubleLinkedList() : free_head_(NIL), size_(0)
+	{
+		nodes_.resize(1);
+		nodes_[0].prev = 0;
+		nodes_[0].next = 0;
+		nodes_[0].count = 0;
+	}
+	~DoubleLinkedList() {}
+
+	//Ԥȷelement_countԪصĽڵ
+	void Reserve(int element_count)
+	{
+		nodes_.reserve(1 + (element_count + NODE_CAPACITY - 1) / NODE_CAPACITY);
+	}
+
+	//뵽β
+	bool InsertNode(const T& value)
+	{
+		unsigned tail = nodes_[0].prev;
+		if (tail == 0 || nodes_[tail].count == NODE_CAPACITY)
+		{
+			unsigned index = AllocNode();
+			if (index == NIL)
+			{
+				return false;
+			}
+			LinkBefore(0, index);
+			tail = index;
+		}
+		ListNode& node = nodes_[tail];
+		node.values[node.count++] = value;
+		size_++;
+		return true;
+	}
+
+	bool FindNode(const T& value) const
+	{
+		unsigned pos = 0;
+		return Locate(value, &pos) != 0;
+	}
+
+	//ɾһvalueԪ
+	bool DeleteNode(const T& value)
+	{
+		unsigned pos = 0;
+		unsigned index = Locate(value, &pos);
+		if (index == 0)
+		{
+			return false;
+		}
+
+		ListNode& node = nodes_[index];
+		for (unsigned i = pos + 1; i < node.count; i++)
+		{
+			node.values[i - 1] = node.values[i];
+		}
+		node.count--;
+		size_--;
+
+		if (node.count == 0)
+		{
+			Unlink(index);
+			FreeNode(index);
+			return true;
+		}
+
+		/*չ:ڵ㲻ʱ̽ڵԪ,ڴ*/
+		unsigned next = node.next;
+		if (NODE_CAPACITY > 1 && node.count < NODE_CAPACITY / 2 && next != 0 &&
+			node.count + nodes_[next].count <= NODE_CAPACITY)
+		{
+			ListNode& next_node = nodes_[next];
+			for (unsigned i = 0; i < next_node.count; i++)
+			{
+				node.values[node.count++] = next_node.values[i];
+			}
+			next_node.count = 0;
+			Unlink(next);
+			FreeNode(next);
+		}
+		return true;
+	}
+
+	//,ڵصڴ汣ظʹ
+	void EmptyList()
+	{
+		nodes_.resize(1);
+		nodes_[0].prev = 0;
+		nodes_[0].next = 0;
+		free_head_ = NIL;
+		size_ = 0;
+	}
+
+	int GetSize() const { return (int)size_; }
+	bool IsEmpty() const { return size_ == 0; }
+
+	void PrintList() const
+	{
+		for (unsigned index = nodes_[0].next; index != 0; index = nodes_[index].next)
+		{
+			const ListNode& node = nodes_[index];
+			for (unsigned i = 0; i < node.count; i++)
+			{
+				std::cout << node.values[i] << " ";
+			}
+		}
+		std::cout << std::endl;
+	}
+
+private:
+	enum { NIL = 0xFFFFFFFFu };
+
+	struct ListNode
+	{
+		unsigned prev;
+		unsigned next;//ڿʱָһнڵ
+		unsigned count;
+		T values[NODE_CAPACITY];
+	};
+
+	//Ԫڽڵ±,posǽڵڵλ;Ҳ0
+	unsigned Locate(const T& value, unsigned* pos) const
+	{
+		for (unsigned index = nodes_[0].next; index != 0; index = nodes_[index].next)
+		{
+			const ListNode& node = nodes_[index];
+			for (unsigned i = 0; i < node.count; i++)
+			{
+				if (node.values[i] == value)
+				{
+					*pos = i;
+					return index;
+				}
+			}
+		}
+		return 0;
+	}
+
+	unsigned AllocNode()
+	{
+		unsigned index = free_head_;
+		if (index != NIL)
+		{
+			free_head_ = nodes_[index].next;
+		}
+		else
+		{
+			if (nodes_.size() >= (size_t)NIL)
+			{
+				return NIL;
+			}
+			index = (unsigned)nodes_.size();
+			nodes_.push_back(ListNode());
+		}
+		nodes_[index].count = 0;
+		return index;
+	}
+
+	void FreeNode(unsigned index)
+	{
+		nodes_[index].next = free_head_;
+		free_head_ = index;
+	}
+
+	void LinkBefore(unsigned pos, unsigned index)
+	{
+		unsigned prev = nodes_[pos].prev;
+		nodes_[index].prev = prev;
+		nodes_[index].next = pos;
+		nodes_[prev].next = index;
+		nodes_[pos].prev = index;
+	}
+
+	void Unlink(unsigned index)
+	{
+		unsigned prev = nodes_[index].prev;
+		unsigned next = nodes_[index].next;
+		nodes_[prev].next = next;
+		nodes_[next].prev = prev;
+	}
+
+	std::vector<ListNode> nodes_;//ڵ,nodes_[0]ڱ
+	unsigned free_head_;
+	unsigned size_;
+};
+
 }
 #endif //_LIB_UTILITY_H_
\ No newline at end of file
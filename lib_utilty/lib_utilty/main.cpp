@@ -118,9 +118,9 @@ void TimerHandler()
 
 int main()
 {
-	utility::TimerTask* task1 = NULL;
-	utility::TimerTask* task2 = NULL;
-	utility::TimerTask* task3 = NULL;
+	utility::TimerHandle task1 = 0;
+	utility::TimerHandle task2 = 0;
+	utility::TimerHandle task3 = 0;
 	utility::TimerNotify* timer_notify = new OnNotify();
 	utility::TimerNotify* timer_notify2 = new OnNotify2();
 	utility::TimerNotify* timer_notify3 = new OnNotify3();
@@ -156,6 +156,8 @@ int main()
 	std::cin.get();
 	timer_thread.StopATimer(task1);
 	timer_thread.StopATimer(task2);
+	//task3 is ONCE and has already fired, stopping its stale handle is a no-op
+	timer_thread.StopATimer(task3);
 	std::cout << "stop Timer" << std::endl;
 	std::cin.get();
 	std::cout << "stop Thread" << std::endl;
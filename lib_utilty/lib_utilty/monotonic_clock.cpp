@@ -0,0 +1,155 @@
+#include "monotonic_clock.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CLOCK_HAS_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define CLOCK_HAS_TSC
+#endif
+#include <thread>
+#include <chrono>
+
+namespace utility {
+
+	std::atomic<unsigned long long> MonotonicClock::cached_now_(0);
+
+	namespace {
+
+#ifdef _WIN32
+		unsigned long long GetQpcFrequency()
+		{
+			static const unsigned long long frequency = []() {
+				LARGE_INTEGER fc;
+				QueryPerformanceFrequency(&fc);
+				return (unsigned long long)fc.QuadPart;
+			}();
+			return frequency;
+		}
+#endif
+
+#ifdef CLOCK_HAS_TSC
+		//CPUID.80000007H:EDX[8],TSCƵʺ㶨,Ƶ߱仯
+		bool HasInvariantTsc()
+		{
+#ifdef _MSC_VER
+			int regs[4] = { 0 };
+			__cpuid(regs, 0x80000000);
+			if ((unsigned)regs[0] < 0x80000007u)
+			{
+				return false;
+			}
+			__cpuid(regs, 0x80000007);
+			return (regs[3] & (1 << 8)) != 0;
+#else
+			unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+			if (__get_cpuid_max(0x80000000u, NULL) < 0x80000007u)
+			{
+				return false;
+			}
+			__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+			return (edx & (1u << 8)) != 0;
+#endif
+		}
+#endif
+
+		/*TSC:ns = base_ns + (tsc - base_tsc) * mult >> TSC_SHIFT.
+		*˷ɸߵ32λ,ܴTSCҲ*/
+		enum { TSC_SHIFT = 24 };
+
+		struct TscCalibration
+		{
+			bool available;
+			unsigned long long base_tsc;
+			unsigned long long base_ns;
+			unsigned long long mult;
+
+			TscCalibration() : available(false), base_tsc(0), base_ns(0), mult(0)
+			{
+#ifdef CLOCK_HAS_TSC
+				if (!HasInvariantTsc())
+				{
+					return;
+				}
+				unsigned long long start_ns = MonotonicClock::NowNs();
+				unsigned long long start_tsc = __rdtsc();
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				unsigned long long end_ns = MonotonicClock::NowNs();
+				unsigned long long end_tsc = __rdtsc();
+				if (end_tsc <= start_tsc || end_ns <= start_ns)
+				{
+					return;
+				}
+				base_tsc = end_tsc;
+				base_ns = end_ns;
+				mult = ((end_ns - start_ns) << TSC_SHIFT) / (end_tsc - start_tsc);
+				available = mult > 0;
+#endif
+			}
+		};
+
+		const TscCalibration& GetTscCalibration()
+		{
+			static const TscCalibration calibration;
+			return calibration;
+		}
+	}
+
+	unsigned long long MonotonicClock::NowNs()
+	{
+#ifdef _WIN32
+		LARGE_INTEGER fc;
+		QueryPerformanceCounter(&fc);
+		unsigned long long counter = (unsigned long long)fc.QuadPart;
+		unsigned long long frequency = GetQpcFrequency();
+		//ȷֳٻ,counter * 10^9,Ҳø
+		return counter / frequency * 1000000000ULL + counter % frequency * 1000000000ULL / frequency;
+#else
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+	}
+
+	unsigned long long MonotonicClock::CoarseNowNs()
+	{
+#ifdef _WIN32
+		return GetTickCount64() * 1000000ULL;
+#elif defined(CLOCK_MONOTONIC_COARSE)
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+		return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+		return NowNs();
+#endif
+	}
+
+	bool MonotonicClock::IsTscAvailable()
+	{
+		return GetTscCalibration().available;
+	}
+
+	unsigned long long MonotonicClock::TscNowNs()
+	{
+		const TscCalibration& calibration = GetTscCalibration();
+		if (!calibration.available)
+		{
+			return NowNs();
+		}
+#ifdef CLOCK_HAS_TSC
+		unsigned long long tsc = __rdtsc();
+		//ϵTSCܱУ׼ʱС,ʱУ׼ʱ̼
+		unsigned long long delta = tsc > calibration.base_tsc ? tsc - calibration.base_tsc : 0;
+		return calibration.base_ns + (((delta >> 32) * calibration.mult) << (32 - TSC_SHIFT))
+			+ (((delta & 0xFFFFFFFFULL) * calibration.mult) >> TSC_SHIFT);
+#else
+		return NowNs();
+#endif
+	}
+
+}
\ No newline at end of file
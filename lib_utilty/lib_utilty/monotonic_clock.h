@@ -0,0 +1,54 @@
+#ifndef _MONOTONIC_CLOCK_H_
+#define _MONOTONIC_CLOCK_H_
+#include <atomic>
+
+namespace utility {
+
+/***********************************************
+*ʱ,޸ϵͳʱNTPУʱӰ,ʱ䶼Ϊλ.
+*NowNs:ȷʱ(CLOCK_MONOTONIC/QueryPerformanceCounter),ȫ;
+*CoarseNowNs:ʱ(CLOCK_MONOTONIC_COARSE/GetTickCount64),Ϊ1~16ms,ȡܿ;
+*TscNowNs:ֱӶTSC,ó˷λ,һεʱУ׼(Լ10ms),
+*	CPUֺ֧㶨ƵʵTSCʱ˻صNowNs;
+*CachedNowNs:ʱ߳ÿαʱµʱ,ȡֻһԭӼ.ᵹ,ܹʱ:
+*	̶ʱһ̶ȼϻصִʱ;޿̶ģʽ¶ʱ߳ߵһʱ,
+*	ûжʱʱһֱ,ʱû.
+************************************************/
+class MonotonicClock
+{
+public:
+	static unsigned long long NowNs();
+	static unsigned long long CoarseNowNs();
+	static unsigned long long TscNowNs();
+	static bool IsTscAvailable();
+
+	//ʱ߳ÿδ̶֮ǰ,ظºʱ.
+	//ʱ߳(Ƭ)ͬʱʱֻϴֵ,ʱ䲻ᵹ
+	static unsigned long long UpdateCachedNow()
+	{
+		unsigned long long now = NowNs();
+		unsigned long long cached = cached_now_.load(std::memory_order_relaxed);
+		while (cached < now)
+		{
+			if (cached_now_.compare_exchange_weak(cached, now, std::memory_order_relaxed))
+			{
+				return now;
+			}
+		}
+		return cached;
+	}
+
+	//û̸߳¹ʱ0,÷Ҫ޵ʱӦʹNowNsCoarseNowNs
+	static unsigned long long CachedNowNs()
+	{
+		return cached_now_.load(std::memory_order_relaxed);
+	}
+
+	static unsigned long long NowMs() { return NowNs() / 1000000; }
+
+private:
+	static std::atomic<unsigned long long> cached_now_;
+};
+
+}
+#endif //_MONOTONIC_CLOCK_H_
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "reactor.h"
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace utility {
+
+	namespace {
+
+		//¼:32λǴ,32λfd
+		unsigned long long MakeEventData(int fd, unsigned generation)
+		{
+			return ((unsigned long long)generation << 32) | (unsigned)fd;
+		}
+	}
+
+	Reactor::Reactor()
+		: epoll_fd_(-1), timer_fd_(-1), wake_fd_(-1), armed_tick_(0), stop_flag_(false),
+		wakeup_count_(0), timer_arm_count_(0)
+	{
+	}
+
+	Reactor::~Reactor()
+	{
+		Close();
+	}
+
+	bool Reactor::Open(int max_events)
+	{
+		Close();
+		epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+		timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (epoll_fd_ < 0 || timer_fd_ < 0 || wake_fd_ < 0)
+		{
+			Close();
+			return false;
+		}
+
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.u64 = MakeEventData(timer_fd_, 0);
+		if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &event) != 0)
+		{
+			Close();
+			return false;
+		}
+		event.data.u64 = MakeEventData(wake_fd_, 0);
+		if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) != 0)
+		{
+			Close();
+			return false;
+		}
+		events_.resize(max_events > 0 ? max_events : 256);
+		armed_tick_ = 0;
+		stop_flag_ = false;
+		return true;
+	}
+
+	void Reactor::Close()
+	{
+		int fds[3] = { epoll_fd_, timer_fd_, wake_fd_ };
+		for (int i = 0; i < 3; i++)
+		{
+			if (fds[i] >= 0)
+			{
+				close(fds[i]);
+			}
+		}
+		epoll_fd_ = -1;
+		timer_fd_ = -1;
+		wake_fd_ = -1;
+		fd_table_.clear();
+	}
+
+	bool Reactor::AddFd(int fd, unsigned events, IoHandler* handler)
+	{
+		if (fd < 0 || handler == NULL)
+		{
+			return false;
+		}
+		if ((size_t)fd >= fd_table_.size())
+		{
+			FdEntry empty = { NULL, 0 };
+			fd_table_.resize(fd + 1 > (int)fd_table_.size() * 2 ? fd + 1 : fd_table_.size() * 2, empty);
+		}
+		FdEntry& entry = fd_table_[fd];
+		entry.generation++;
+
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = events;
+		event.data.u64 = MakeEventData(fd, entry.generation);
+		if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+		{
+			return false;
+		}
+		entry.handler = handler;
+		return true;
+	}
+
+	bool Reactor::ModifyFd(int fd, unsigned events)
+	{
+		if (fd < 0 || (size_t)fd >= fd_table_.size() || fd_table_[fd].handler == NULL)
+		{
+			return false;
+		}
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = events;
+		event.data.u64 = MakeEventData(fd, fd_table_[fd].generation);
+		return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0;
+	}
+
+	void Reactor::RemoveFd(int fd)
+	{
+		if (fd < 0 || (size_t)fd >= fd_table_.size() || fd_table_[fd].handler == NULL)
+		{
+			return;
+		}
+		epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, NULL);
+		fd_table_[fd].handler = NULL;
+		fd_table_[fd].generation++;
+	}
+
+	::TimerManager& Reactor::GetTimerManager()
+	{
+		return timer_manager_;
+	}
+
+	void Reactor::RunLoop()
+	{
+		while (!stop_flag_.load(std::memory_order_acquire))
+		{
+			if (RunOnce(-1) < 0)
+			{
+				break;
+			}
+		}
+	}
+
+	int Reactor::RunOnce(int timeout_ms)
+	{
+		ArmTimer();
+		int count = epoll_wait(epoll_fd_, &events_[0], (int)events_.size(), timeout_ms);
+		if (count < 0)
+		{
+			return errno == EINTR ? 0 : -1;
+		}
+		wakeup_count_++;
+
+		bool timer_due = false;
+		for (int i = 0; i < count; i++)
+		{
+			int fd = (int)(unsigned)events_[i].data.u64;
+			unsigned generation = (unsigned)(events_[i].data.u64 >> 32);
+			if (fd == timer_fd_)
+			{
+				//timerfd֮ٴ,Ҫ趨
+				DrainFd(timer_fd_);
+				armed_tick_ = 0;
+				timer_due = true;
+				continue;
+			}
+			if (fd == wake_fd_)
+			{
+				DrainFd(wake_fd_);
+				continue;
+			}
+			//ǰĻصѾɾfd,fdѾµ
+			if ((size_t)fd < fd_table_.size() && fd_table_[fd].handler != NULL &&
+				fd_table_[fd].generation == generation)
+			{
+				fd_table_[fd].handler->OnIoEvents(fd, events_[i].events);
+			}
+		}
+		if (timer_due)
+		{
+			timer_manager_.DetectTimers();
+		}
+		//¼,˵fdܸ,´ζȡһЩ
+		if (count == (int)events_.size())
+		{
+			events_.resize(events_.size() * 2);
+		}
+		return count;
+	}
+
+	void Reactor::Stop()
+	{
+		stop_flag_.store(true, std::memory_order_release);
+		unsigned long long value = 1;
+		if (wake_fd_ >= 0 && write(wake_fd_, &value, sizeof(value)) != sizeof(value))
+		{
+			//ʱѾδĻ
+		}
+	}
+
+	unsigned long long Reactor::GetWakeupCount()
+	{
+		return wakeup_count_;
+	}
+
+	unsigned long long Reactor::GetTimerArmCount()
+	{
+		return timer_arm_count_;
+	}
+
+	void Reactor::ArmTimer()
+	{
+		/*ʱֵĿ̶Ⱦǵʱӵĺ,timerfdCLOCK_MONOTONICʱһ.
+		*ڿ̶Ѿȡ,ڿ̶ȿʼʱѲڶʱĵʱ*/
+		unsigned long long next_tick = 0;
+		if (!timer_manager_.GetNextPendingTick(&next_tick))
+		{
+			next_tick = 0;
+		}
+		if (next_tick == armed_tick_)
+		{
+			return;
+		}
+
+		itimerspec spec;
+		memset(&spec, 0, sizeof(spec));
+		if (next_tick != 0)
+		{
+			spec.it_value.tv_sec = (time_t)(next_tick / 1000);
+			spec.it_value.tv_nsec = (long)(next_tick % 1000) * 1000000L;
+		}
+		if (timerfd_settime(timer_fd_, next_tick != 0 ? TFD_TIMER_ABSTIME : 0, &spec, NULL) == 0)
+		{
+			armed_tick_ = next_tick;
+			timer_arm_count_++;
+		}
+	}
+
+	void Reactor::DrainFd(int fd)
+	{
+		unsigned long long value = 0;
+		while (read(fd, &value, sizeof(value)) == sizeof(value))
+		{
+		}
+	}
+
+}
+
+#endif //__linux__
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef _REACTOR_H_
+#define _REACTOR_H_
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <vector>
+#include <atomic>
+#include "timer_wheel.h"
+
+namespace utility {
+
+//fd֪ͨ,зӦ߳е
+class IoHandler
+{
+public:
+	virtual ~IoHandler() {}
+	virtual void OnIoEvents(int fd, unsigned events) = 0;//eventsEPOLLIN/EPOLLOUT/EPOLLERR/EPOLLHUPȵ
+};
+
+/***********************************************
+*LinuxӦ:һepollѭͬʱfdͶʱ,صRunLoopִ߳,,߳̽.
+*ʱʹtimer_wheel.hеTimerManager(1ms̶,DetectTimersʱӲйڵĿ̶),
+*GetTimerManager()Timer.ֻһtimerfd,ʱΪʱһҪĿ̶,
+*̶ֻȱ仯ʱ;ûжʱʱر,ת.
+*ͬһȷַfdٴʱ,յݵöRescheduleƺĿгʱ󴥷.
+*Stop֮ĽӿֻRunLoop߳е,ѭ֮ǰһ߳е.
+************************************************/
+class Reactor
+{
+public:
+	Reactor();
+	~Reactor();
+
+	//epolltimerfdStopeventfd,ʧʱfalse
+	bool Open(int max_events = 256);
+	void Close();
+
+	//handlerɵ÷,RemoveFd֮󲻻ٱ
+	bool AddFd(int fd, unsigned events, IoHandler* handler);
+	bool ModifyFd(int fd, unsigned events);
+	//ڻصеҲ:ֻûзַfd¼,ʹfdѾµ
+	void RemoveFd(int fd);
+
+	::TimerManager& GetTimerManager();
+
+	void RunLoop();//һֱеStop
+	int RunOnce(int timeout_ms = -1);//ȴһβַ,ؾ¼,ʱ-1
+	void Stop();//̵߳
+
+	unsigned long long GetWakeupCount();//epoll_waitصĴ
+	unsigned long long GetTimerArmCount();//timerfdĴ
+
+private:
+	Reactor(const Reactor&);
+	Reactor& operator=(const Reactor&);
+
+	struct FdEntry
+	{
+		IoHandler* handler;
+		unsigned generation;//ÿμɾʱ1,¼дżʱĴ
+	};
+
+	void ArmTimer();
+	void DrainFd(int fd);
+
+	int epoll_fd_;
+	int timer_fd_;
+	int wake_fd_;
+	unsigned long long armed_tick_;//timerfdǰ趨Ŀ̶,0ʾû趨
+	std::vector<epoll_event> events_;
+	std::vector<FdEntry> fd_table_;//fd±
+	::TimerManager timer_manager_;
+	std::atomic<bool> stop_flag_;
+	unsigned long long wakeup_count_;
+	unsigned long long timer_arm_count_;
+};
+
+}
+
+#endif //__linux__
+#endif //_REACTOR_H_
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "timer_coroutine.h"
+
+namespace utility {
+
+	TimerWaiter::TimerWaiter()
+		: timer_(NULL), executor_(NULL), source_(NULL), source_prev_(NULL), source_next_(NULL),
+		source_linked_(false), state_(WAITER_PENDING)
+	{
+	}
+
+	bool TimerWaiter::Complete(WaitResult result)
+	{
+		/*޸״̬֮ʱָ߳̿ȴ,timer_Ҫȶ*/
+		CoroutineTimer* timer = timer_;
+		unsigned state = state_.load(std::memory_order_acquire);
+		do
+		{
+			if ((state & ~(unsigned)WAITER_ARMING) != WAITER_PENDING)
+			{
+				return false;
+			}
+		} while (!state_.compare_exchange_weak(state, state | result, std::memory_order_acq_rel));
+
+		if (timer == NULL)
+		{
+			return true;
+		}
+		/*ʱֵڶʱ,ʱ̴߳ʱֱӻָ;
+		*Ѿʱʱɶʱ߳ժ֮ٻָ*/
+		if ((state & WAITER_ARMING) == 0)
+		{
+			timer->PostWaiter(this);
+		}
+		return false;
+	}
+
+	void TimerWaiter::Resume()
+	{
+		if (executor_ != NULL)
+		{
+			executor_->PostTask(this);
+		}
+		else
+		{
+			Execute();
+		}
+	}
+
+	CoroutineEvent::CoroutineEvent()
+		: mutex_("", MUTEX_ADAPTIVE), head_(NULL), tail_(NULL), signaled_(false)
+	{
+	}
+
+	CoroutineEvent::~CoroutineEvent()
+	{
+	}
+
+	void CoroutineEvent::SetEvent()
+	{
+		/*ɵȴ,ʱĶʱ߳Ҫõժ֮ŻָЭ,ʵĵȴЧ;
+		*Ҫɵָ̻߳ĵȴsource_next_,֮ٻָ*/
+		TimerWaiter* ready = NULL;
+		TimerWaiter* ready_tail = NULL;
+		mutex_.LockObject();
+		signaled_.store(true, std::memory_order_release);
+		TimerWaiter* waiter = head_;
+		head_ = NULL;
+		tail_ = NULL;
+		while (waiter != NULL)
+		{
+			TimerWaiter* next = waiter->source_next_;
+			waiter->source_linked_ = false;
+			waiter->source_next_ = NULL;
+			if (waiter->Complete(TimerWaiter::WAITER_SIGNALED))
+			{
+				if (ready_tail == NULL)
+				{
+					ready = waiter;
+				}
+				else
+				{
+					ready_tail->source_next_ = waiter;
+				}
+				ready_tail = waiter;
+			}
+			waiter = next;
+		}
+		mutex_.UnlockObject();
+
+		while (ready != NULL)
+		{
+			TimerWaiter* next = ready->source_next_;
+			ready->Resume();
+			ready = next;
+		}
+	}
+
+	void CoroutineEvent::ResetEvent()
+	{
+		signaled_.store(false, std::memory_order_release);
+	}
+
+	bool CoroutineEvent::IsSignaled()
+	{
+		return signaled_.load(std::memory_order_acquire);
+	}
+
+	bool CoroutineEvent::AddWaiter(TimerWaiter* waiter)
+	{
+		MutexGuard guard(mutex_);
+		if (signaled_.load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+		waiter->source_prev_ = tail_;
+		waiter->source_next_ = NULL;
+		waiter->source_linked_ = true;
+		if (tail_ == NULL)
+		{
+			head_ = waiter;
+		}
+		else
+		{
+			tail_->source_next_ = waiter;
+		}
+		tail_ = waiter;
+		return true;
+	}
+
+	void CoroutineEvent::RemoveWaiter(TimerWaiter* waiter)
+	{
+		MutexGuard guard(mutex_);
+		if (!waiter->source_linked_)
+		{
+			return;
+		}
+		if (waiter->source_prev_ == NULL)
+		{
+			head_ = waiter->source_next_;
+		}
+		else
+		{
+			waiter->source_prev_->source_next_ = waiter->source_next_;
+		}
+		if (waiter->source_next_ == NULL)
+		{
+			tail_ = waiter->source_prev_;
+		}
+		else
+		{
+			waiter->source_next_->source_prev_ = waiter->source_prev_;
+		}
+		waiter->source_linked_ = false;
+	}
+
+	CoroutineTimer::CoroutineTimer()
+		: executor_(NULL)
+	{
+		exit_flag_ = FALSE;
+		expire_count_ = 0;
+	}
+
+	CoroutineTimer::~CoroutineTimer()
+	{
+		StopTimerThread();
+	}
+
+	void CoroutineTimer::ThreadWorkFunc(THREAD_PARAMETERS*)
+	{
+		while (!exit_flag_)
+		{
+			/*ȸλ¼ٴ,λ֮Ͷݵĵȴ*/
+			comm_event_.ResetEvent();
+			ProcessWaiters();
+			timer_wheel_.Advance([this](TimerWheelHook* node) { ExpireWaiter(node); });
+			if (exit_flag_)
+			{
+				break;
+			}
+
+			unsigned long long wait_ns = 0;
+			if (!timer_wheel_.GetNextExpireNs(&wait_ns))
+			{
+				comm_event_.WaitForEventSignaled();
+				continue;
+			}
+			unsigned long long wait_ms = (wait_ns + 999999) / 1000000;
+			if (wait_ms > 0)
+			{
+				comm_event_.WaitForEventSignaled(wait_ms > 0x7fffffff ? 0x7fffffff : (int)wait_ms);
+			}
+		}
+	}
+
+	void CoroutineTimer::OnBeforeThreadExiting()
+	{
+		exit_flag_ = TRUE;
+		comm_event_.SetEvent();
+	}
+
+	BOOL CoroutineTimer::StartTimerThread(int core_id)
+	{
+		exit_flag_ = FALSE;
+		if (!CreateThread())
+		{
+			return FALSE;
+		}
+		if (core_id >= 0)
+		{
+			SetThreadAffinity(0, core_id);
+		}
+		return TRUE;
+	}
+
+	void CoroutineTimer::StopTimerThread()
+	{
+		exit_flag_ = TRUE;
+		DestroyThreads();
+	}
+
+	void CoroutineTimer::SetExecutor(ThreadPool* executor)
+	{
+		executor_ = executor;
+	}
+
+	ThreadPool* CoroutineTimer::GetExecutor()
+	{
+		return executor_;
+	}
+
+	unsigned long long CoroutineTimer::GetExpireCount()
+	{
+		return expire_count_.load(std::memory_order_relaxed);
+	}
+
+	void CoroutineTimer::ArmWaiter(TimerWaiter* waiter, unsigned interval_ms)
+	{
+		if (waiter->timer_ != this)
+		{
+			waiter->timer_ = this;//awaiterʱûָʱ
+		}
+		waiter->expire_tick_ = timer_wheel_.GetDeadlineTick((unsigned long long)interval_ms * 1000000ULL);
+		waiter->state_.fetch_or(TimerWaiter::WAITER_ARMING, std::memory_order_relaxed);
+		PostWaiter(waiter);
+	}
+
+	void CoroutineTimer::PostWaiter(TimerWaiter* waiter)
+	{
+		waiter_queue_.Push(waiter);
+		comm_event_.SetEvent();
+	}
+
+	void CoroutineTimer::ProcessWaiters()
+	{
+		PoolTask* task = NULL;
+		while ((task = waiter_queue_.Pop()) != NULL)
+		{
+			TimerWaiter* waiter = static_cast<TimerWaiter*>(task);
+			unsigned state = waiter->state_.fetch_and(~(unsigned)TimerWaiter::WAITER_ARMING, std::memory_order_acq_rel);
+			if (state == TimerWaiter::WAITER_ARMING)
+			{
+				timer_wheel_.Insert(waiter);
+				continue;
+			}
+			//֮ǰʱеȴʱѾ
+			timer_wheel_.Remove(waiter);
+			waiter->Resume();
+		}
+	}
+
+	void CoroutineTimer::ExpireWaiter(TimerWheelHook* node)
+	{
+		TimerWaiter* waiter = static_cast<TimerWaiter*>(node);
+		unsigned state = TimerWaiter::WAITER_PENDING;
+		if (!waiter->state_.compare_exchange_strong(state, TimerWaiter::WAITER_TIMEOUT, std::memory_order_acq_rel))
+		{
+			return;//Ѿź,ڶ,ʱָ
+		}
+		if (waiter->source_ != NULL)
+		{
+			waiter->source_->RemoveWaiter(waiter);
+		}
+		expire_count_.fetch_add(1, std::memory_order_relaxed);
+		waiter->Resume();
+	}
+
+}
\ No newline at end of file
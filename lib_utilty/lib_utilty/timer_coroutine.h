@@ -0,0 +1,240 @@
+#ifndef _TIMER_COROUTINE_H_
+#define _TIMER_COROUTINE_H_
+#include "lib_utility.h"
+
+/***********************************************
+*Э̶ʱ:һ߳ӵ1ms̶ȵʱ,ÿЭ̶ӦһTimerWaiter,
+*TimerWaiterǶawaiter(ҲЭ֡),ʱ֡Ͷݸʱ̺߳ͽ̳߳ػָʹ,
+*ÿι𲻷ڴ.
+*ⱾC++11;SleepFor/Wait/WithTimeoutawaitableڱļĩβ,ֻڱ֧C++20Эʱṩ.:
+*	co_await SleepFor(timer, 100);
+*	bool signaled = co_await WithTimeout(timer, Wait(event), 500);
+*ֹͣʱ߳ʱڵȴЭ̲ᱻָ,Э֡ɵ÷.
+************************************************/
+namespace utility {
+
+class CoroutineTimer;
+class WaitSource;
+
+//һεȴ.state_λʾʱֵûбʱ̴߳,λǵȴĽ
+class TimerWaiter : public TimerWheelHook, public PoolTask
+{
+public:
+	enum WaitResult { WAITER_PENDING = 0, WAITER_TIMEOUT = 2, WAITER_SIGNALED = 4 };
+
+	TimerWaiter();
+
+	WaitResult GetResult() const
+	{
+		return (WaitResult)(state_.load(std::memory_order_acquire) & ~(unsigned)WAITER_ARMING);
+	}
+
+	/*resultɵȴ,̵߳.trueʱɵ÷Resume;
+	*ѾɡҪɶʱ̴߳ʱժ֮ٻָʱfalse*/
+	bool Complete(WaitResult result);
+	void Resume();//executor_,ûʱڵǰָ̻߳
+
+	virtual void Execute() = 0;//ָЭ
+	void Discard() {}//ֹ̳߳ͣʱ,Э֡ɵ÷
+
+protected:
+	friend class CoroutineTimer;
+	friend class CoroutineEvent;
+
+	enum { WAITER_ARMING = 1 };
+
+	CoroutineTimer* timer_;//ûгʱʱΪNULL
+	ThreadPool* executor_;
+	WaitSource* source_;//ȴԴ,Դ֮޸
+	TimerWaiter* source_prev_;//ֻԴڷ
+	TimerWaiter* source_next_;
+	bool source_linked_;
+	std::atomic<unsigned> state_;
+};
+
+//ԱЭ̵ȴȴʱȡԴ
+class WaitSource
+{
+public:
+	virtual ~WaitSource() {}
+	virtual bool IsSignaled() = 0;
+	virtual bool AddWaiter(TimerWaiter* waiter) = 0;//Ѿź״̬ʱfalse,
+	virtual void RemoveWaiter(TimerWaiter* waiter) = 0;//ʱʱɶʱ̵߳,ѾժʱʲôҲ
+};
+
+//Э¼:SetEvent֮еȴЭָ̻,ֱResetEvent.̵߳
+class CoroutineEvent : public WaitSource
+{
+public:
+	CoroutineEvent();
+	~CoroutineEvent();
+
+	void SetEvent();
+	void ResetEvent();
+	bool IsSignaled();
+	bool AddWaiter(TimerWaiter* waiter);
+	void RemoveWaiter(TimerWaiter* waiter);
+
+private:
+	CoroutineEvent(const CoroutineEvent&);
+	CoroutineEvent& operator=(const CoroutineEvent&);
+
+	CommonMutex mutex_;
+	TimerWaiter* head_;
+	TimerWaiter* tail_;
+	std::atomic<bool> signaled_;
+};
+
+//Э̶ʱ߳
+class CoroutineTimer : public MultiThreads<CoroutineTimer, 1>
+{
+public:
+	CoroutineTimer();
+	~CoroutineTimer();
+
+	void ThreadWorkFunc(THREAD_PARAMETERS* work_para);
+	void OnBeforeThreadExiting();
+
+	BOOL StartTimerThread(int core_id = -1);
+	void StopTimerThread();
+	//Ĭĸ̳߳лָЭ,ΪNULLʱڶʱ߳лָ.֮߳ǰ
+	void SetExecutor(ThreadPool* executor);
+	ThreadPool* GetExecutor();
+	unsigned long long GetExpireCount();//ʱָĴ
+
+	//interval_ms֮WAITER_TIMEOUTɵȴ,̵߳.֮waiterʱָܱ
+	void ArmWaiter(TimerWaiter* waiter, unsigned interval_ms);
+
+private:
+	friend class TimerWaiter;
+
+	CoroutineTimer(const CoroutineTimer&);
+	CoroutineTimer& operator=(const CoroutineTimer&);
+
+	void PostWaiter(TimerWaiter* waiter);
+	void ProcessWaiters();//ֻڶʱ߳е
+	void ExpireWaiter(TimerWheelHook* node);
+
+	TimerTaskWheel timer_wheel_;//ֻڶʱ߳޸
+	PoolTaskQueue waiter_queue_;//ʱֺǰɵ,һTimerWaiterͬʱֻڶгһ
+	ThreadPool* executor_;
+	std::atomic<BOOL> exit_flag_;
+	std::atomic<unsigned long long> expire_count_;
+	utility::CommonEvent comm_event_;
+};
+
+}
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define UTILITY_HAS_COROUTINE 1
+#endif
+#endif
+
+#ifdef UTILITY_HAS_COROUTINE
+namespace utility {
+
+//awaiterĹ,ָʱñЭ̾
+class CoroutineWaiter : public TimerWaiter
+{
+public:
+	void Execute() { handle_.resume(); }
+
+protected:
+	CoroutineWaiter(CoroutineTimer* timer, WaitSource* source, ThreadPool* executor)
+	{
+		timer_ = timer;
+		source_ = source;
+		executor_ = executor;
+	}
+
+	std::coroutine_handle<> handle_;
+};
+
+//co_await SleepFor(...):interval_msָ֮
+class SleepAwaiter : public CoroutineWaiter
+{
+public:
+	SleepAwaiter(CoroutineTimer& timer, unsigned interval_ms, ThreadPool* executor)
+		: CoroutineWaiter(&timer, NULL, executor), interval_ms_(interval_ms)
+	{
+	}
+
+	bool await_ready() const noexcept { return interval_ms_ == 0; }
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		handle_ = handle;
+		timer_->ArmWaiter(this, interval_ms_);
+	}
+	void await_resume() const noexcept {}
+
+private:
+	unsigned interval_ms_;
+};
+
+//co_await Wait(...)WithTimeout(...):Դźʱtrue,ʱfalse
+class WaitAwaiter : public CoroutineWaiter
+{
+public:
+	WaitAwaiter(WaitSource& source, CoroutineTimer* timer, unsigned interval_ms, ThreadPool* executor)
+		: CoroutineWaiter(timer, &source, executor), interval_ms_(interval_ms)
+	{
+	}
+
+	bool await_ready() const noexcept { return source_->IsSignaled(); }
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		handle_ = handle;
+		/*ȱΪȴʱ,ټԴ:Դڷʱ֮ǰɵȴʱ,
+		*ɶʱ̴߳ʱָ,;ָ.
+		*ûгʱʱԴ֮ʱָܱ̻߳,֮ٷʳԱ,ҪõȸƳ*/
+		CoroutineTimer* timer = timer_;
+		unsigned interval_ms = interval_ms_;
+		if (timer != NULL)
+		{
+			state_.store(WAITER_ARMING, std::memory_order_relaxed);
+		}
+		if (!source_->AddWaiter(this))
+		{
+			state_.store(WAITER_SIGNALED, std::memory_order_relaxed);
+			return false;
+		}
+		if (timer != NULL)
+		{
+			timer->ArmWaiter(this, interval_ms);
+		}
+		return true;
+	}
+	bool await_resume() const noexcept { return GetResult() != WAITER_TIMEOUT; }
+
+	WaitSource& GetSource() const { return *source_; }
+	ThreadPool* GetExecutor() const { return executor_; }
+
+private:
+	unsigned interval_ms_;
+};
+
+//executorΪNULLʱʹöʱĬ̳߳
+inline SleepAwaiter SleepFor(CoroutineTimer& timer, unsigned interval_ms, ThreadPool* executor = NULL)
+{
+	return SleepAwaiter(timer, interval_ms, executor != NULL ? executor : timer.GetExecutor());
+}
+
+//ûгʱ,executorΪNULLʱɵȴ߳(SetEvent߳)лָ
+inline WaitAwaiter Wait(WaitSource& source, ThreadPool* executor = NULL)
+{
+	return WaitAwaiter(source, NULL, 0, executor);
+}
+
+//Wait(...)ϳʱ,ʱЭڶʱ̻߳executorлָ
+inline WaitAwaiter WithTimeout(CoroutineTimer& timer, WaitAwaiter&& wait, unsigned interval_ms)
+{
+	ThreadPool* executor = wait.GetExecutor() != NULL ? wait.GetExecutor() : timer.GetExecutor();
+	return WaitAwaiter(wait.GetSource(), &timer, interval_ms, executor);
+}
+
+}
+#endif //UTILITY_HAS_COROUTINE
+
+#endif //_TIMER_COROUTINE_H_
\ No newline at end of file
@@ -0,0 +1,194 @@
+#ifndef _TIMER_HEAP_H_
+#define _TIMER_HEAP_H_
+#include <vector>
+#include "hierarchical_wheel.h"
+
+namespace utility {
+
+/***********************************************
+*4СѶʱ,ڿ̶,ӿTimerWheelͬ,Ի滻.
+*б(ڿ̶,ڵ),Ƚʱʽڵ,4ӽڵ(64λ¹64ֽ,ûаж).
+*ڵslot_ڶеλ,ڶʱΪ-1,ֹͣʱλֱɾ,O(log n).
+*ûвۺͼ,ʱʱʱռõĻ;ڿ̶ûзΧ.
+*ͬһ̶ȵڵĽڵ㲻֤˳򴥷.ֻһ߳ʹ.
+************************************************/
+class TimerHeap
+{
+public:
+	enum { ARITY = 4, WHEEL_LEVELS = 0 };
+
+	explicit TimerHeap(unsigned long long start_tick = 0)
+		: current_tick_(start_tick)
+	{
+	}
+
+	//ؽڵڶеλ,֮ѵĵ仯
+	int Insert(TimerWheelHook* node)
+	{
+		int index = (int)heap_.size();
+		heap_.push_back(HeapEntry());
+		return SiftUp(index, MakeEntry(node));
+	}
+
+	template <class Node>
+	void InsertBatch(Node** nodes, int count)
+	{
+		heap_.reserve(heap_.size() + count);
+		for (int i = 0; i < count; i++)
+		{
+			Insert(nodes[i]);
+		}
+	}
+
+	//ڶʱʲôҲ
+	void Remove(TimerWheelHook* node)
+	{
+		if (!IsLinked(node))
+		{
+			return;
+		}
+		int index = node->slot_;
+		node->slot_ = -1;
+		HeapEntry last = heap_.back();
+		heap_.pop_back();
+		if (last.node == node)
+		{
+			return;
+		}
+		//һڵλ,ȸڵʱϸ,³
+		if (index > 0 && last.expire_tick < heap_[(index - 1) / ARITY].expire_tick)
+		{
+			SiftUp(index, last);
+		}
+		else
+		{
+			SiftDown(index, last);
+		}
+	}
+
+	//ʵɾĸ
+	template <class Node>
+	int RemoveBatch(Node** nodes, int count)
+	{
+		int removed = 0;
+		for (int i = 0; i < count; i++)
+		{
+			if (IsLinked(nodes[i]))
+			{
+				Remove(nodes[i]);
+				removed++;
+			}
+		}
+		return removed;
+	}
+
+	static bool IsLinked(const TimerWheelHook* node) { return node->slot_ >= 0; }
+
+	/*now_tick()ΪֹеڵĽڵ,ڿ̶ȵ˳handler.OnExpire(node).
+	*ʱڵѾӶɾ,GetCurrentTick()ڴĿ̶+1,TimerWheelһ*/
+	template <class Handler>
+	void AdvanceTo(unsigned long long now_tick, Handler& handler)
+	{
+		while (!heap_.empty() && heap_[0].expire_tick <= now_tick)
+		{
+			TimerWheelHook* node = heap_[0].node;
+			if (node->expire_tick_ >= current_tick_)
+			{
+				current_tick_ = node->expire_tick_ + 1;
+			}
+			Remove(node);
+			handler.OnExpire(node);
+		}
+		if (current_tick_ <= now_tick)
+		{
+			current_tick_ = now_tick + 1;
+		}
+	}
+
+	//ĵڿ̶,ѾڵİһҪĿ̶ȷ;ûжʱʱfalse
+	bool GetNextPendingTick(unsigned long long* next_tick) const
+	{
+		if (heap_.empty())
+		{
+			return false;
+		}
+		unsigned long long expire_tick = heap_[0].expire_tick;
+		*next_tick = expire_tick > current_tick_ ? expire_tick : current_tick_;
+		return true;
+	}
+
+	unsigned long long GetCurrentTick() const { return current_tick_; }//һҪĿ̶
+	size_t GetCount() const { return heap_.size(); }
+	int GetOccupiedSlots(int) const { return 0; }//ûв,ͳʱ
+
+private:
+	TimerHeap(const TimerHeap&);
+	TimerHeap& operator=(const TimerHeap&);
+
+	struct HeapEntry
+	{
+		unsigned long long expire_tick;//ڵ㵽ڿ̶ȵĸ,ڵڶʱ޸
+		TimerWheelHook* node;
+	};
+
+	static HeapEntry MakeEntry(TimerWheelHook* node)
+	{
+		HeapEntry entry = { node->expire_tick_, node };
+		return entry;
+	}
+
+	int SiftUp(int index, HeapEntry entry)
+	{
+		while (index > 0)
+		{
+			int parent = (index - 1) / ARITY;
+			if (entry.expire_tick >= heap_[parent].expire_tick)
+			{
+				break;
+			}
+			heap_[index] = heap_[parent];
+			heap_[index].node->slot_ = index;
+			index = parent;
+		}
+		heap_[index] = entry;
+		entry.node->slot_ = index;
+		return index;
+	}
+
+	void SiftDown(int index, HeapEntry entry)
+	{
+		int count = (int)heap_.size();
+		for (;;)
+		{
+			int first_child = index * ARITY + 1;
+			if (first_child >= count)
+			{
+				break;
+			}
+			int last_child = first_child + ARITY < count ? first_child + ARITY : count;
+			int min_child = first_child;
+			for (int child = first_child + 1; child < last_child; child++)
+			{
+				if (heap_[child].expire_tick < heap_[min_child].expire_tick)
+				{
+					min_child = child;
+				}
+			}
+			if (heap_[min_child].expire_tick >= entry.expire_tick)
+			{
+				break;
+			}
+			heap_[index] = heap_[min_child];
+			heap_[index].node->slot_ = index;
+			index = min_child;
+		}
+		heap_[index] = entry;
+		entry.node->slot_ = index;
+	}
+
+	std::vector<HeapEntry> heap_;
+	unsigned long long current_tick_;
+};
+
+}
+#endif //_TIMER_HEAP_H_
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "timer_stats.h"
+#include "lib_utility.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace utility {
+
+	namespace {
+
+		//̵߳ͳƿ,ֻӲͷ
+		struct StatsRegistry
+		{
+			CommonMutex mutex;
+			std::vector<TimerThreadStats*> blocks;
+			TimerThreadStats* free_list;
+
+			StatsRegistry() : free_list(NULL) {}
+		};
+
+		StatsRegistry& GetRegistry()
+		{
+			static StatsRegistry* registry = new StatsRegistry();
+			return *registry;
+		}
+
+		//߳˳ʱͳƿŻؿ,˲ʱֵ,ۼֵ
+		struct StatsHolder
+		{
+			TimerThreadStats* stats;
+
+			StatsHolder() : stats(NULL) {}
+			~StatsHolder()
+			{
+				if (stats == NULL)
+				{
+					return;
+				}
+				stats->live_timers_.store(0, std::memory_order_relaxed);
+				for (int level = 0; level < STATS_MAX_LEVELS; level++)
+				{
+					stats->occupied_slots_[level].store(0, std::memory_order_relaxed);
+				}
+				StatsRegistry& registry = GetRegistry();
+				registry.mutex.LockObject();
+				stats->next_free_ = registry.free_list;
+				registry.free_list = stats;
+				registry.mutex.UnlockObject();
+			}
+		};
+
+		void AppendHistogram(std::string& json, const char* name, const HistogramSnapshot& histogram, bool last)
+		{
+			char buffer[256];
+			snprintf(buffer, sizeof(buffer),
+				"\"%s\":{\"count\":%llu,\"mean\":%.1f,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}%s",
+				name, histogram.GetCount(), histogram.GetMean(), histogram.GetPercentile(50), histogram.GetPercentile(90),
+				histogram.GetPercentile(99), histogram.GetPercentile(99.9), histogram.GetMax(), last ? "" : ",");
+			json += buffer;
+		}
+
+		double PerSecond(unsigned long long current, unsigned long long previous,
+			unsigned long long current_ns, unsigned long long previous_ns)
+		{
+			if (current_ns <= previous_ns || current < previous)
+			{
+				return 0;
+			}
+			return (double)(current - previous) * 1e9 / (double)(current_ns - previous_ns);
+		}
+	}
+
+	StatsHistogram::StatsHistogram()
+	{
+		for (int i = 0; i < BUCKET_COUNT; i++)
+		{
+			counts_[i].store(0, std::memory_order_relaxed);
+		}
+		count_ = 0;
+		sum_ = 0;
+		max_ = 0;
+	}
+
+	unsigned long long StatsHistogram::GetBucketUpperBound(int index)
+	{
+		if (index < SUB_COUNT)
+		{
+			return (unsigned long long)index;
+		}
+		int shift = index / SUB_COUNT - 1;
+		unsigned long long lower = (unsigned long long)(SUB_COUNT + index % SUB_COUNT) << shift;
+		return lower + ((1ULL << shift) - 1);
+	}
+
+	HistogramSnapshot::HistogramSnapshot()
+		: count_(0), sum_(0), max_(0)
+	{
+		memset(counts_, 0, sizeof(counts_));
+	}
+
+	void HistogramSnapshot::Add(const StatsHistogram& histogram)
+	{
+		for (int i = 0; i < StatsHistogram::BUCKET_COUNT; i++)
+		{
+			counts_[i] += histogram.counts_[i].load(std::memory_order_relaxed);
+		}
+		count_ += histogram.count_.load(std::memory_order_relaxed);
+		sum_ += histogram.sum_.load(std::memory_order_relaxed);
+		unsigned long long max_value = histogram.max_.load(std::memory_order_relaxed);
+		if (max_value > max_)
+		{
+			max_ = max_value;
+		}
+	}
+
+	double HistogramSnapshot::GetMean() const
+	{
+		return count_ > 0 ? (double)sum_ / (double)count_ : 0;
+	}
+
+	unsigned long long HistogramSnapshot::GetPercentile(double percent) const
+	{
+		/*ͰǷֱȡ,count_г,ͰĺϼƼ*/
+		unsigned long long total = 0;
+		for (int i = 0; i < StatsHistogram::BUCKET_COUNT; i++)
+		{
+			total += counts_[i];
+		}
+		if (total == 0)
+		{
+			return 0;
+		}
+		unsigned long long rank = (unsigned long long)(percent / 100.0 * (double)total + 0.5);
+		if (rank < 1)
+		{
+			rank = 1;
+		}
+		unsigned long long seen = 0;
+		for (int i = 0; i < StatsHistogram::BUCKET_COUNT; i++)
+		{
+			seen += counts_[i];
+			if (seen >= rank)
+			{
+				unsigned long long upper = StatsHistogram::GetBucketUpperBound(i);
+				return upper < max_ ? upper : max_;
+			}
+		}
+		return max_;
+	}
+
+	TimerThreadStats::TimerThreadStats()
+		: arms_(0), cancels_(0), reschedules_(0), fires_(0), cascades_(0), callbacks_(0), live_timers_(0),
+		wheel_levels_(0), clock_ns_(0), detect_cascades_(0), next_free_(NULL)
+	{
+		for (int level = 0; level < STATS_MAX_LEVELS; level++)
+		{
+			occupied_slots_[level].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	TimerStatsSnapshot::TimerStatsSnapshot()
+		: time_ns_(0), threads_(0), arms_(0), cancels_(0), reschedules_(0), fires_(0), cascades_(0),
+		callbacks_(0), live_timers_(0), wheel_levels_(0)
+	{
+		memset(occupied_slots_, 0, sizeof(occupied_slots_));
+	}
+
+	double TimerStatsSnapshot::GetArmsPerSecond(const TimerStatsSnapshot& previous) const
+	{
+		return PerSecond(arms_, previous.arms_, time_ns_, previous.time_ns_);
+	}
+
+	double TimerStatsSnapshot::GetCancelsPerSecond(const TimerStatsSnapshot& previous) const
+	{
+		return PerSecond(cancels_, previous.cancels_, time_ns_, previous.time_ns_);
+	}
+
+	std::string TimerStatsSnapshot::ToJson() const
+	{
+		char buffer[512];
+		snprintf(buffer, sizeof(buffer),
+			"{\"time_ns\":%llu,\"threads\":%d,\"arms\":%llu,\"cancels\":%llu,\"reschedules\":%llu,\"fires\":%llu,"
+			"\"cascades\":%llu,\"callbacks\":%llu,\"live_timers\":%llu,\"occupied_slots\":[",
+			time_ns_, threads_, arms_, cancels_, reschedules_, fires_, cascades_, callbacks_, live_timers_);
+		std::string json = buffer;
+		for (int level = 0; level < wheel_levels_; level++)
+		{
+			snprintf(buffer, sizeof(buffer), "%s%llu", level > 0 ? "," : "", occupied_slots_[level]);
+			json += buffer;
+		}
+		json += "],";
+		AppendHistogram(json, "lateness_ns", lateness_ns_, false);
+		AppendHistogram(json, "callback_ns", callback_ns_, false);
+		AppendHistogram(json, "cascade_size", cascade_size_, true);
+		json += "}";
+		return json;
+	}
+
+	void TimerStats::GetSnapshot(TimerStatsSnapshot* snapshot)
+	{
+		*snapshot = TimerStatsSnapshot();
+		snapshot->time_ns_ = MonotonicClock::NowNs();
+
+		StatsRegistry& registry = GetRegistry();
+		registry.mutex.LockObject();
+		snapshot->threads_ = (int)registry.blocks.size();
+		for (size_t i = 0; i < registry.blocks.size(); i++)
+		{
+			const TimerThreadStats* stats = registry.blocks[i];
+			snapshot->arms_ += stats->arms_.load(std::memory_order_relaxed);
+			snapshot->cancels_ += stats->cancels_.load(std::memory_order_relaxed);
+			snapshot->reschedules_ += stats->reschedules_.load(std::memory_order_relaxed);
+			snapshot->fires_ += stats->fires_.load(std::memory_order_relaxed);
+			snapshot->cascades_ += stats->cascades_.load(std::memory_order_relaxed);
+			snapshot->callbacks_ += stats->callbacks_.load(std::memory_order_relaxed);
+			snapshot->live_timers_ += stats->live_timers_.load(std::memory_order_relaxed);
+			int levels = stats->wheel_levels_.load(std::memory_order_relaxed);
+			if (levels > snapshot->wheel_levels_)
+			{
+				snapshot->wheel_levels_ = levels;
+			}
+			for (int level = 0; level < levels; level++)
+			{
+				snapshot->occupied_slots_[level] += stats->occupied_slots_[level].load(std::memory_order_relaxed);
+			}
+			snapshot->lateness_ns_.Add(stats->lateness_ns_);
+			snapshot->callback_ns_.Add(stats->callback_ns_);
+			snapshot->cascade_size_.Add(stats->cascade_size_);
+		}
+		registry.mutex.UnlockObject();
+	}
+
+	TimerThreadStats* TimerStats::RegisterThread()
+	{
+		static thread_local StatsHolder holder;
+
+		StatsRegistry& registry = GetRegistry();
+		registry.mutex.LockObject();
+		TimerThreadStats* stats = registry.free_list;
+		if (stats != NULL)
+		{
+			registry.free_list = stats->next_free_;
+			stats->next_free_ = NULL;
+		}
+		else
+		{
+			stats = new TimerThreadStats();
+			registry.blocks.push_back(stats);
+		}
+		registry.mutex.UnlockObject();
+
+		holder.stats = stats;
+		LocalSlot() = stats;
+		return stats;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#ifndef _TIMER_STATS_H_
+#define _TIMER_STATS_H_
+#include <string>
+#include <atomic>
+#include "monotonic_clock.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/***********************************************
+*ʱͳ:/ֹͣ//ڴ,ӳ١صʱÿδ̶ʱֱͼ,
+*Ķʱ͸ʱֵķǿղ.
+*ÿֻ߳дԼͳƿ(relaxedԭӶд,),TimerStats::GetSnapshot߳.
+*ӳʹöʱ߳һζȡʱ,صʱÿ16βһ,ÿδʱ.
+*ͷǿղÿDetectTimers֮,һ߳TimerManagerʱֻһ.
+*ʱӺ궨NO_TIMER_STATSȥȫͳƴ,ʱȫΪ0.
+************************************************/
+#ifdef NO_TIMER_STATS
+#define TIMER_STAT(...)
+#else
+#define TIMER_STAT(...) __VA_ARGS__
+#endif
+
+namespace utility {
+
+/*HDRֱͼ:λ,ÿԷֳ16Ͱ,1/16.
+*ֻһ̼߳¼,߳̿ͬʱȡ*/
+class StatsHistogram
+{
+public:
+	enum { SUB_BITS = 4, SUB_COUNT = 1 << SUB_BITS, BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT };
+
+	StatsHistogram();
+
+	void Record(unsigned long long value)
+	{
+		Increase(counts_[GetBucketIndex(value)], 1);
+		Increase(count_, 1);
+		Increase(sum_, value);
+		if (value > max_.load(std::memory_order_relaxed))
+		{
+			max_.store(value, std::memory_order_relaxed);
+		}
+	}
+
+	static int GetBucketIndex(unsigned long long value)
+	{
+		if (value < SUB_COUNT)
+		{
+			return (int)value;
+		}
+		int shift = FindLastSetBit(value) - SUB_BITS;
+		return (shift + 1) * SUB_COUNT + (int)((value >> shift) - SUB_COUNT);
+	}
+	static unsigned long long GetBucketUpperBound(int index);//Ͱֵ
+
+	//д߼,ҪԭӼ
+	static void Increase(std::atomic<unsigned long long>& counter, unsigned long long value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+private:
+	friend class HistogramSnapshot;
+	StatsHistogram(const StatsHistogram&);
+	StatsHistogram& operator=(const StatsHistogram&);
+
+	static int FindLastSetBit(unsigned long long value)
+	{
+#if defined(_MSC_VER)
+		unsigned long bit = 0;
+#if defined(_M_X64) || defined(_M_ARM64)
+		_BitScanReverse64(&bit, value);
+#else
+		if (_BitScanReverse(&bit, (unsigned long)(value >> 32)))
+		{
+			bit += 32;
+		}
+		else
+		{
+			_BitScanReverse(&bit, (unsigned long)value);
+		}
+#endif
+		return (int)bit;
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+
+	std::atomic<unsigned long long> counts_[BUCKET_COUNT];
+	std::atomic<unsigned long long> count_;
+	std::atomic<unsigned long long> sum_;
+	std::atomic<unsigned long long> max_;
+};
+
+//ֱͼĻܽ,Ժϲ̵ֱ߳ͼ
+class HistogramSnapshot
+{
+public:
+	HistogramSnapshot();
+
+	void Add(const StatsHistogram& histogram);
+	unsigned long long GetCount() const { return count_; }
+	unsigned long long GetMax() const { return max_; }
+	double GetMean() const;
+	unsigned long long GetPercentile(double percent) const;//percentΪ0~100,ͰϽ(ֵ)
+
+private:
+	unsigned long long counts_[StatsHistogram::BUCKET_COUNT];
+	unsigned long long count_;
+	unsigned long long sum_;
+	unsigned long long max_;
+};
+
+enum { STATS_MAX_LEVELS = 8 };
+
+//һ̵߳ͳƿ,߳˳֮һ̼߳ۼ,ᶪʧ
+struct TimerThreadStats
+{
+	TimerThreadStats();
+
+	std::atomic<unsigned long long> arms_;
+	std::atomic<unsigned long long> cancels_;
+	std::atomic<unsigned long long> reschedules_;
+	std::atomic<unsigned long long> fires_;
+	std::atomic<unsigned long long> cascades_;//Ķʱ
+	std::atomic<unsigned long long> callbacks_;
+	std::atomic<unsigned long long> live_timers_;
+	std::atomic<int> wheel_levels_;
+	std::atomic<int> occupied_slots_[STATS_MAX_LEVELS];
+	StatsHistogram lateness_ns_;
+	StatsHistogram callback_ns_;
+	StatsHistogram cascade_size_;
+
+	//̷ֻ߳
+	unsigned long long clock_ns_;//һζȡʱ
+	unsigned long long detect_cascades_;//DetectTimersʼʱcascades_
+	TimerThreadStats* next_free_;
+};
+
+//֮ͳƽ
+struct TimerStatsSnapshot
+{
+	TimerStatsSnapshot();
+
+	//һο֮ÿ/ֹͣ
+	double GetArmsPerSecond(const TimerStatsSnapshot& previous) const;
+	double GetCancelsPerSecond(const TimerStatsSnapshot& previous) const;
+	std::string ToJson() const;
+
+	unsigned long long time_ns_;//ɿʱĵʱ
+	int threads_;
+	unsigned long long arms_;
+	unsigned long long cancels_;
+	unsigned long long reschedules_;
+	unsigned long long fires_;
+	unsigned long long cascades_;
+	unsigned long long callbacks_;
+	unsigned long long live_timers_;
+	int wheel_levels_;
+	unsigned long long occupied_slots_[STATS_MAX_LEVELS];//߳ͬһķǿղ֮
+	HistogramSnapshot lateness_ns_;
+	HistogramSnapshot callback_ns_;
+	HistogramSnapshot cascade_size_;
+};
+
+class TimerStats
+{
+public:
+	static void GetSnapshot(TimerStatsSnapshot* snapshot);
+
+	static TimerThreadStats* Local()
+	{
+		TimerThreadStats* stats = LocalSlot();
+		return stats != NULL ? stats : RegisterThread();
+	}
+
+	static void RecordArm(unsigned count = 1) { StatsHistogram::Increase(Local()->arms_, count); }
+	static void RecordCancel(unsigned count = 1) { StatsHistogram::Increase(Local()->cancels_, count); }
+	static void RecordReschedule() { StatsHistogram::Increase(Local()->reschedules_, 1); }
+	static void RecordCascade() { StatsHistogram::Increase(Local()->cascades_, 1); }
+
+	//̶֮ǰһʱ,֮ĵӳٶʱӼ
+	static void BeginDetect()
+	{
+		TimerThreadStats* stats = Local();
+		stats->clock_ns_ = MonotonicClock::NowNs();
+		stats->detect_cascades_ = stats->cascades_.load(std::memory_order_relaxed);
+	}
+
+	template <class Wheel>
+	static void EndDetect(const Wheel& wheel)
+	{
+		TimerThreadStats* stats = Local();
+		unsigned long long cascades = stats->cascades_.load(std::memory_order_relaxed) - stats->detect_cascades_;
+		if (cascades > 0)
+		{
+			stats->cascade_size_.Record(cascades);
+		}
+		stats->live_timers_.store(wheel.GetCount(), std::memory_order_relaxed);
+		int levels = (int)Wheel::WHEEL_LEVELS < (int)STATS_MAX_LEVELS ? (int)Wheel::WHEEL_LEVELS : (int)STATS_MAX_LEVELS;
+		stats->wheel_levels_.store(levels, std::memory_order_relaxed);
+		for (int level = 0; level < levels; level++)
+		{
+			stats->occupied_slots_[level].store(wheel.GetOccupiedSlots(level), std::memory_order_relaxed);
+		}
+	}
+
+	static void RecordFire(unsigned long long deadline_ns)
+	{
+		TimerThreadStats* stats = Local();
+		StatsHistogram::Increase(stats->fires_, 1);
+		stats->lateness_ns_.Record(stats->clock_ns_ > deadline_ns ? stats->clock_ns_ - deadline_ns : 0);
+	}
+
+	//ʱ0
+	static unsigned long long BeginCallback()
+	{
+		TimerThreadStats* stats = Local();
+		unsigned long long sequence = stats->callbacks_.load(std::memory_order_relaxed);
+		stats->callbacks_.store(sequence + 1, std::memory_order_relaxed);
+		return (sequence & CALLBACK_SAMPLE_MASK) == 0 ? MonotonicClock::NowNs() : 0;
+	}
+
+	static void EndCallback(unsigned long long start_ns)
+	{
+		if (start_ns == 0)
+		{
+			return;
+		}
+		TimerThreadStats* stats = Local();
+		stats->clock_ns_ = MonotonicClock::NowNs();
+		stats->callback_ns_.Record(stats->clock_ns_ - start_ns);
+	}
+
+private:
+	enum { CALLBACK_SAMPLE_MASK = 15 };
+
+	static TimerThreadStats* RegisterThread();
+
+	//ڵthread_localʼ,ʱҪǷѳʼ
+	static TimerThreadStats*& LocalSlot()
+	{
+		static thread_local TimerThreadStats* local = NULL;
+		return local;
+	}
+};
+
+}
+#endif //_TIMER_STATS_H_
\ No newline at end of file
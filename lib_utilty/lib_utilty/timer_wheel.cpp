@@ -4,27 +4,13 @@
 
 #define _CRT_SECURE_NO_WARNINGS
 #include "timer_wheel.h"
-#ifdef _MSC_VER
-# include <sys/timeb.h>
-#else
-# include <sys/time.h>
-#endif
-
-#define TVN_BITS 6
-#define TVR_BITS 8
-#define TVN_SIZE (1 << TVN_BITS)
-#define TVR_SIZE (1 << TVR_BITS)
-#define TVN_MASK (TVN_SIZE - 1)
-#define TVR_MASK (TVR_SIZE - 1)
-#define OFFSET(N) (TVR_SIZE + (N) *TVN_SIZE)
-#define INDEX(V, N) ((V >> (TVR_BITS + (N) *TVN_BITS)) & TVN_MASK)
+#include "monotonic_clock.h"
 
 //////////////////////////////////////////////////////////////////////////
 // Timer
 
 Timer::Timer(TimerManager& manager)
 	: manager_(manager)
-	, vecIndex_(-1)
 {
 }
 
@@ -35,24 +21,37 @@ Timer::~Timer()
 
 void Timer::Stop()
 {
-	if (vecIndex_ != -1)
+	manager_.RemoveTimer(this);
+}
+
+void Timer::Reschedule(unsigned interval, bool lazy)
+{
+	if (!TimerManager::Wheel::IsLinked(this))
+		return;
+
+	unsigned long long deadline = TimerManager::DeadlineToTick(utility::MonotonicClock::NowNs(), interval);
+	if (lazy && deadline >= expire_tick_)
 	{
-		manager_.RemoveTimer(this);
-		vecIndex_ = -1;
+		// Only the next expiry moves; a CIRCLE timer keeps its period.
+		deadline_ = deadline;
+		return;
 	}
+
+	manager_.RemoveTimer(this);
+	interval_ = interval;
+	expire_tick_ = deadline;
+	deadline_ = deadline;
+	manager_.AddTimer(this);
 }
 
-void Timer::OnTimer(unsigned long long now)
+void Timer::OnTimer(unsigned long long now_ns)
 {
 	if (timerType_ == Timer::CIRCLE)
 	{
-		expires_ = interval_ + now;
+		expire_tick_ = TimerManager::DeadlineToTick(now_ns, interval_);
+		deadline_ = expire_tick_;
 		manager_.AddTimer(this);
 	}
-	else
-	{
-		vecIndex_ = -1;
-	}
 	timerFun_();
 }
 
@@ -61,108 +60,64 @@ void Timer::OnTimer(unsigned long long now)
 
 TimerManager::TimerManager()
 {
-	tvec_.resize(TVR_SIZE + 4 * TVN_SIZE);
-	checkTime_ = GetCurrentMillisecs();
+	wheel_ = new Wheel(GetCurrentMillisecs());
 }
 
-void TimerManager::AddTimer(Timer* timer)
+TimerManager::~TimerManager()
 {
-	unsigned long long expires = timer->expires_;
-	unsigned long long idx = expires - checkTime_;
-
-	if (idx < TVR_SIZE)
-	{
-		timer->vecIndex_ = expires & TVR_MASK;
-	}
-	else if (idx < 1 << (TVR_BITS + TVN_BITS))
-	{
-		timer->vecIndex_ = OFFSET(0) + INDEX(expires, 0);
-	}
-	else if (idx < 1 << (TVR_BITS + 2 * TVN_BITS))
-	{
-		timer->vecIndex_ = OFFSET(1) + INDEX(expires, 1);
-	}
-	else if (idx < 1 << (TVR_BITS + 3 * TVN_BITS))
-	{
-		timer->vecIndex_ = OFFSET(2) + INDEX(expires, 2);
-	}
-	else if ((long long)idx < 0)
-	{
-		timer->vecIndex_ = checkTime_ & TVR_MASK;
-	}
-	else
-	{
-		if (idx > 0xffffffffUL)
-		{
-			idx = 0xffffffffUL;
-			expires = idx + checkTime_;
-		}
-		timer->vecIndex_ = OFFSET(3) + INDEX(expires, 3);
-	}
+	delete wheel_;
+}
 
-	TimeList& tlist = tvec_[timer->vecIndex_];
-	tlist.push_back(timer);
-	timer->itr_ = tlist.end();
-	--timer->itr_;
+void TimerManager::AddTimer(Timer* timer)
+{
+	wheel_->Insert(timer);
 }
 
 void TimerManager::RemoveTimer(Timer* timer)
 {
-	TimeList& tlist = tvec_[timer->vecIndex_];
-	tlist.erase(timer->itr_);
+	wheel_->Remove(timer);
 }
 
 void TimerManager::DetectTimers()
 {
-	unsigned long long now = GetCurrentMillisecs();
-	while (checkTime_ <= now)
-	{
-		int index = checkTime_ & TVR_MASK;
-		if (!index &&
-			!Cascade(OFFSET(0), INDEX(checkTime_, 0)) &&
-			!Cascade(OFFSET(1), INDEX(checkTime_, 1)) &&
-			!Cascade(OFFSET(2), INDEX(checkTime_, 2)))
-		{
-			Cascade(OFFSET(3), INDEX(checkTime_, 3));
-		}
-		++checkTime_;
-
-		TimeList& tlist = tvec_[index];
-		TimeList temp;
-		temp.splice(temp.end(), tlist);
-		for (TimeList::iterator itr = temp.begin(); itr != temp.end(); ++itr)
-		{
-			(*itr)->OnTimer(now);
-		}
-	}
+	unsigned long long now_ns = utility::MonotonicClock::NowNs();
+	Handler handler = { now_ns };
+	wheel_->AdvanceTo(now_ns / 1000000, handler);
 }
 
-int TimerManager::Cascade(int offset, int index)
+bool TimerManager::GetNextPendingTick(unsigned long long* tick) const
 {
-	TimeList& tlist = tvec_[offset + index];
-	TimeList temp;
-	temp.splice(temp.end(), tlist);
+	return wheel_->GetNextPendingTick(tick);
+}
 
-	for (TimeList::iterator itr = temp.begin(); itr != temp.end(); ++itr)
+void TimerManager::Handler::OnCascade(utility::TimerWheelHook* node)
+{
+	Timer* timer = static_cast<Timer*>(node);
+	if (timer->deadline_ > timer->expire_tick_)
+		timer->expire_tick_ = timer->deadline_;
+}
+
+void TimerManager::Handler::OnExpire(utility::TimerWheelHook* node)
+{
+	Timer* timer = static_cast<Timer*>(node);
+	if (timer->deadline_ > timer->expire_tick_)
 	{
-		AddTimer(*itr);
+		// Pushed back by a lazy Reschedule: re-file instead of firing.
+		timer->expire_tick_ = timer->deadline_;
+		timer->manager_.AddTimer(timer);
+		return;
 	}
-
-	return index;
+	timer->OnTimer(now_ns_);
 }
 
+// Monotonic, so expiries do not jump when the wall clock is stepped.
 unsigned long long TimerManager::GetCurrentMillisecs()
 {
-#ifdef _MSC_VER
-	_timeb timebuffer;
-	_ftime(&timebuffer);
-	unsigned long long ret = timebuffer.time;
-	ret = ret * 1000 + timebuffer.millitm;
-	return ret;
-#else
-	timeval tv;
-	::gettimeofday(&tv, 0);
-	unsigned long long ret = tv.tv_sec;
-	return ret * 1000 + tv.tv_usec / 1000;
-#endif
+	return utility::MonotonicClock::NowMs();
+}
+
+// Rounded up in ns: flooring now to the ms first would fire up to 1 ms early.
+unsigned long long TimerManager::DeadlineToTick(unsigned long long now_ns, unsigned interval)
+{
+	return (now_ns + interval * 1000000ULL + 999999) / 1000000;
 }
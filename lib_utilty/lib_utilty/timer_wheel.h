@@ -1,12 +1,12 @@
 // header file //////////////////////////////////
 #pragma once
-#include <list>
-#include <vector>
-#include <functional>
+#include "inline_function.h"
+#include "hierarchical_wheel.h"
 
 class TimerManager;
 
-class Timer
+// The wheel hook holds the filed expiry (ms) and the slot.
+class Timer : public utility::TimerWheelHook
 {
 public:
 	enum TimerType { ONCE, CIRCLE };
@@ -17,42 +17,63 @@ public:
 	template<typename Fun>
 	void Start(Fun fun, unsigned interval, TimerType timeType = CIRCLE);
 	void Stop();
+	// Moves the expiry to interval ms from now in O(1) and makes interval the
+	// new period. In lazy mode a later expiry only records the new deadline;
+	// the timer stays in its slot and is re-filed when that slot fires or
+	// cascades, and a CIRCLE timer keeps its period.
+	void Reschedule(unsigned interval, bool lazy = false);
 
 private:
-	void OnTimer(unsigned long long now);
+	void OnTimer(unsigned long long now_ns);
 
 private:
 	friend class TimerManager;
 
 	TimerManager& manager_;
 	TimerType timerType_;
-	std::function<void(void)> timerFun_;
+	// Callables up to 48 bytes are stored inline; firing never allocates.
+	utility::InlineFunction<48> timerFun_;
 	unsigned interval_;
-	unsigned long long expires_;
-
-	int vecIndex_;
-	std::list<Timer*>::iterator itr_;
+	// Requested expiry; later than expire_tick_ after a lazy Reschedule.
+	unsigned long long deadline_;
 };
 
 class TimerManager
 {
 public:
 	TimerManager();
+	~TimerManager();
 
 	static unsigned long long GetCurrentMillisecs();
 	void DetectTimers();
+	// Earliest tick (absolute ms on the monotonic clock) that needs a
+	// DetectTimers call, either an expiry or a cascade; false when idle.
+	bool GetNextPendingTick(unsigned long long* tick) const;
 
 private:
 	friend class Timer;
+	// 1 ms ticks counted on the monotonic clock; 2^32 ms span.
+	typedef utility::TimerWheel<1000000ULL, 8, 6, 4> Wheel;
+
+	// First tick at or after interval ms from now_ns; never early.
+	static unsigned long long DeadlineToTick(unsigned long long now_ns, unsigned interval);
+
+	// Callbacks from Wheel::AdvanceTo.
+	struct Handler
+	{
+		unsigned long long now_ns_;
+		void OnCascade(utility::TimerWheelHook* node);
+		void OnExpire(utility::TimerWheelHook* node);
+	};
+
 	void AddTimer(Timer* timer);
 	void RemoveTimer(Timer* timer);
 
-	int Cascade(int offset, int index);
-
 private:
-	typedef std::list<Timer*> TimeList;
-	std::vector<TimeList> tvec_;
-	unsigned long long checkTime_;
+	TimerManager(const TimerManager&);
+	TimerManager& operator=(const TimerManager&);
+
+	Wheel* wheel_;
 };
 
 template<typename Fun>
@@ -60,8 +81,9 @@ inline void Timer::Start(Fun fun, unsigned interval, TimerType timeType)
 {
 	Stop();
 	interval_ = interval;
-	timerFun_ = fun;
+	timerFun_ = std::move(fun);
 	timerType_ = timeType;
-	expires_ = interval_ + TimerManager::GetCurrentMillisecs();
+	expire_tick_ = TimerManager::DeadlineToTick(utility::MonotonicClock::NowNs(), interval_);
+	deadline_ = expire_tick_;
 	manager_.AddTimer(this);
 }